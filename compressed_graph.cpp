@@ -0,0 +1,274 @@
+#include "compressed_graph.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "sorting.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define COMPRESSED_GRAPH_X86 1
+#include <immintrin.h>
+#else
+#define COMPRESSED_GRAPH_X86 0
+#endif
+
+
+static unsigned LengthCode(uint32_t value)
+{
+    return (value < (1u << 8)) ? 0 : (value < (1u << 16)) ? 1 : (value < (1u << 24)) ? 2 : 3;
+}
+
+// Appends the block of a vertex with the sorted neighbours 'neighbours[0, count)'.
+static void EncodeBlock(std::vector<uint8_t>& output, uint32_t vertex, const uint32_t* neighbours, uint32_t count)
+{
+    uint32_t degree = count;
+    while (degree >= 0x80)
+    {
+        output.push_back(uint8_t(degree | 0x80));
+        degree >>= 7;
+    }
+    output.push_back(uint8_t(degree));
+
+    size_t controls = output.size();
+    output.resize(controls + (count + 3) / 4, 0);
+
+    uint32_t previous = vertex;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t value = (i == 0) ? ZigZagEncode(neighbours[0] - vertex) : neighbours[i] - previous;
+        previous = neighbours[i];
+
+        unsigned code = LengthCode(value);
+        output[controls + i / 4] |= uint8_t(code << (2 * (i % 4)));
+        for (unsigned byte = 0; byte <= code; ++byte)
+            output.push_back(uint8_t(value >> (8 * byte)));
+    }
+}
+
+
+CompressedCsrGraph::CompressedCsrGraph(const CsrGraph& graph, ThreadPool& pool) :
+    vertex_count(graph.VertexCount()), edge_count(graph.EdgeCount())
+{
+    const size_t*   offsets    = graph.Offsets();
+    const uint32_t* neighbours = graph.Neighbours();
+
+    // Checked up front, as the tasks can't throw.
+    for (size_t v = 0; v < this->vertex_count; ++v)
+        if (offsets[v + 1] - offsets[v] > size_t(UINT32_MAX))
+            throw std::runtime_error("CompressedCsrGraph only supports degrees below 2^32.");
+
+    this->offsets = make_unique<size_t[]>(this->vertex_count + 1);
+
+    // Every chunk of vertices is encoded into a buffer of its own, with offsets relative to it, and
+    // then the buffers are moved into place once their sizes are known.
+    const size_t chunk_count = (this->vertex_count + COMPRESSED_GRAPH_GRAIN_SIZE - 1) / COMPRESSED_GRAPH_GRAIN_SIZE;
+    std::vector<std::vector<uint8_t>> chunks(chunk_count);
+
+    ParallelFor(pool, 0, chunk_count, 1, [&](size_t begin, size_t end)
+    {
+        std::vector<uint32_t> sorted;
+        for (size_t chunk = begin; chunk < end; ++chunk)
+        {
+            const size_t first = chunk * COMPRESSED_GRAPH_GRAIN_SIZE;
+            const size_t last  = std::min(this->vertex_count, first + COMPRESSED_GRAPH_GRAIN_SIZE);
+
+            std::vector<uint8_t>& output = chunks[chunk];
+            output.reserve(2 * (offsets[last] - offsets[first]) + 2 * (last - first));
+
+            for (size_t v = first; v < last; ++v)
+            {
+                const size_t degree = offsets[v + 1] - offsets[v];
+                sorted.assign(neighbours + offsets[v], neighbours + offsets[v + 1]);
+                if (!std::is_sorted(sorted.begin(), sorted.end()))
+                    IntroSort(sorted.data(), sorted.size());
+
+                this->offsets[v] = output.size();
+                EncodeBlock(output, uint32_t(v), sorted.data(), uint32_t(degree));
+            }
+        }
+    });
+
+    std::vector<size_t> chunk_offsets(chunk_count + 1, 0);
+    for (size_t chunk = 0; chunk < chunk_count; ++chunk)
+        chunk_offsets[chunk + 1] = chunk_offsets[chunk] + chunks[chunk].size();
+
+    const size_t encoded_size = chunk_offsets[chunk_count];
+    this->byte_count = encoded_size + COMPRESSED_GRAPH_PADDING;
+    this->bytes      = make_unique<uint8_t[]>(this->byte_count);
+    this->offsets[this->vertex_count] = encoded_size;
+
+    ParallelFor(pool, 0, chunk_count, 1, [&](size_t begin, size_t end)
+    {
+        for (size_t chunk = begin; chunk < end; ++chunk)
+        {
+            const size_t first = chunk * COMPRESSED_GRAPH_GRAIN_SIZE;
+            const size_t last  = std::min(this->vertex_count, first + COMPRESSED_GRAPH_GRAIN_SIZE);
+
+            for (size_t v = first; v < last; ++v)
+                this->offsets[v] += chunk_offsets[chunk];
+
+            if (!chunks[chunk].empty())
+                memcpy(this->bytes.get() + chunk_offsets[chunk], chunks[chunk].data(), chunks[chunk].size());
+            std::vector<uint8_t>().swap(chunks[chunk]);
+        }
+    });
+}
+
+
+// The first group is decoded one value at a time, as its first value is relative to the vertex.
+static const uint8_t* DecodeFirstGroup(uint32_t vertex, const uint8_t* controls, const uint8_t* data, uint32_t count, uint32_t* output)
+{
+    const uint32_t first_count = std::min<uint32_t>(count, 4);
+
+    uint32_t value = vertex + ZigZagDecode(ReadStreamVByte(data, *controls & 3));
+    output[0] = value;
+    for (uint32_t i = 1; i < first_count; ++i)
+    {
+        value += ReadStreamVByte(data, (*controls >> (2 * i)) & 3);
+        output[i] = value;
+    }
+    return data;
+}
+
+static void DecodeScalar(uint32_t vertex, const uint8_t* controls, const uint8_t* data, uint32_t count, uint32_t* output)
+{
+    if (count == 0)
+        return;
+
+    data = DecodeFirstGroup(vertex, controls, data, count, output);
+
+    uint32_t value = output[std::min<uint32_t>(count, 4) - 1];
+    for (uint32_t i = 4; i < count; ++i)
+    {
+        value += ReadStreamVByte(data, (controls[i / 4] >> (2 * (i % 4))) & 3);
+        output[i] = value;
+    }
+}
+
+
+#if COMPRESSED_GRAPH_X86
+
+// The shuffle that moves the (up to) four values of a group, as described by its control byte, into
+// the four 32-bit lanes, filling the unused high bytes with zeros, and the total length of the group.
+struct GroupShuffles
+{
+    alignas(16) uint8_t masks[256][16];
+    uint8_t lengths[256];
+
+    GroupShuffles()
+    {
+        for (unsigned control = 0; control < 256; ++control)
+        {
+            unsigned source = 0;
+            for (unsigned lane = 0; lane < 4; ++lane)
+            {
+                unsigned length = ((control >> (2 * lane)) & 3) + 1;
+                for (unsigned byte = 0; byte < 4; ++byte)
+                    this->masks[control][4 * lane + byte] = (byte < length) ? uint8_t(source + byte) : 0x80;
+                source += length;
+            }
+            this->lengths[control] = uint8_t(source);
+        }
+    }
+};
+
+static const GroupShuffles GROUP_SHUFFLES;
+
+__attribute__((target("ssse3")))
+static void DecodeSsse3(uint32_t vertex, const uint8_t* controls, const uint8_t* data, uint32_t count, uint32_t* output)
+{
+    if (count == 0)
+        return;
+
+    data = DecodeFirstGroup(vertex, controls, data, count, output);
+
+    uint32_t i = 4;
+    __m128i previous = _mm_set1_epi32(int(output[std::min<uint32_t>(count, 4) - 1]));
+    for (; i + 4 <= count; i += 4)
+    {
+        const uint8_t control = controls[i / 4];
+
+        __m128i gaps = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) data),
+                                        _mm_load_si128((const __m128i*) GROUP_SHUFFLES.masks[control]));
+        data += GROUP_SHUFFLES.lengths[control];
+
+        // Prefix sum of the four gaps, plus the last value of the previous group.
+        gaps = _mm_add_epi32(gaps, _mm_slli_si128(gaps, 4));
+        gaps = _mm_add_epi32(gaps, _mm_slli_si128(gaps, 8));
+        gaps = _mm_add_epi32(gaps, previous);
+        _mm_storeu_si128((__m128i*) (output + i), gaps);
+
+        previous = _mm_shuffle_epi32(gaps, 0xFF);
+    }
+
+    uint32_t value = uint32_t(_mm_cvtsi128_si32(previous));
+    for (; i < count; ++i)
+    {
+        value += ReadStreamVByte(data, (controls[i / 4] >> (2 * (i % 4))) & 3);
+        output[i] = value;
+    }
+}
+
+static bool HasSsse3()
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("ssse3");
+}
+
+static void DecodeBlock(uint32_t vertex, const uint8_t* controls, const uint8_t* data, uint32_t count, uint32_t* output)
+{
+    static const bool ssse3 = HasSsse3();
+
+    if (ssse3)
+        DecodeSsse3(vertex, controls, data, count, output);
+    else
+        DecodeScalar(vertex, controls, data, count, output);
+}
+
+#else
+
+static void DecodeBlock(uint32_t vertex, const uint8_t* controls, const uint8_t* data, uint32_t count, uint32_t* output)
+{
+    DecodeScalar(vertex, controls, data, count, output);
+}
+
+#endif
+
+
+size_t CompressedCsrGraph::Decode(size_t i, uint32_t* output) const
+{
+    const uint8_t* controls = this->bytes.get() + this->offsets[i];
+    const uint32_t count    = ReadDegree(controls);
+
+    DecodeBlock(uint32_t(i), controls, controls + (count + 3) / 4, count, output);
+    return count;
+}
+
+// 'CsrGraph' can't be filled from outside, so the arrays are built here and handed to it as a view
+// that keeps them alive.
+CsrGraph CompressedCsrGraph::Decompress(ThreadPool& pool) const
+{
+    struct Arrays
+    {
+        unique_ptr<size_t[]>   offsets;
+        unique_ptr<uint32_t[]> neighbours;
+    };
+
+    auto arrays = std::make_shared<Arrays>();
+    arrays->offsets    = make_unique<size_t[]>(this->vertex_count + 1);
+    arrays->neighbours = unique_ptr<uint32_t[]>(new uint32_t[this->edge_count]);
+
+    size_t* offsets = arrays->offsets.get();
+    for (size_t v = 0; v < this->vertex_count; ++v)
+        offsets[v + 1] = offsets[v] + this->Degree(v);
+
+    ParallelFor(pool, 0, this->vertex_count, COMPRESSED_GRAPH_GRAIN_SIZE, [&](size_t begin, size_t end)
+    {
+        for (size_t v = begin; v < end; ++v)
+            this->Decode(v, arrays->neighbours.get() + offsets[v]);
+    });
+
+    const uint32_t* neighbours = arrays->neighbours.get();
+    return CsrGraph(this->vertex_count, this->edge_count, offsets, neighbours, std::move(arrays));
+}
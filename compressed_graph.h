@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+#include "graphs.h"
+#include "thread_pool.h"
+
+
+// A CSR graph with compressed neighbour lists, for graphs whose neighbour array doesn't fit in memory.
+// Every list is sorted and stored as the gaps between consecutive neighbours, which are small when
+// the vertex IDs have some locality (see 'VertexOrder'), and the gaps are packed with Stream VByte:
+// https://arxiv.org/abs/1709.08990
+// Each gap takes 1 to 4 bytes, and the lengths are kept apart from the bytes, as 2-bit codes four to a
+// control byte. Decoding then needs no branch per byte like a classic varint: the length of a value
+// is a lookup of its code, and four values are decoded with one shuffle using the control byte as the
+// index of the shuffle mask.
+//
+// The block of vertex v starts at byte offsets[v] and is
+//     [degree as a LEB128 varint] [ceil(degree / 4) control bytes] [data bytes]
+// where the first value is the zigzag encoded difference between the first neighbour and v, as
+// neighbours tend to be close to the vertex itself, and the rest are the gaps. Memory is
+// 8 * (V + 1) bytes of offsets plus 1.25 to 5 bytes per edge; a sorted or reordered graph usually
+// takes 1.5 to 2.5, compared to 4 for 'CsrGraph'.
+//
+// 'Edge(v)' returns the list as a range of 'CompressedNeighbourIterator', which decodes the neighbours
+// as it steps through them, so the searches in graphs.h run on the compressed graph directly.
+constexpr size_t COMPRESSED_GRAPH_GRAIN_SIZE = 1 << 12;   // Vertices per encoding task.
+constexpr size_t COMPRESSED_GRAPH_PADDING    = 16;        // Bytes after the last block, so a decoder can always load 16.
+
+// Reads the value with 2-bit length code 'code' and moves past it. Loads 4 bytes whatever the length,
+// which the padding makes safe, and masks off the bytes of the next values. Assumes a little endian CPU.
+inline uint32_t ReadStreamVByte(const uint8_t*& data, unsigned code)
+{
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    data += code + 1;
+    return value & (UINT32_MAX >> (24 - 8 * code));
+}
+
+inline uint32_t ZigZagDecode(uint32_t value) { return (value >> 1) ^ (0u - (value & 1)); }
+inline uint32_t ZigZagEncode(uint32_t value) { return (value << 1) ^ uint32_t(int32_t(value) >> 31); }
+
+
+// Decodes the four values of a group, the gaps after 'previous', and returns the byte after them.
+inline const uint8_t* ReadStreamVByteGroup(const uint8_t* data, uint8_t control, uint32_t previous, uint32_t* values)
+{
+    values[0] = previous  + ReadStreamVByte(data,  control       & 3);
+    values[1] = values[0] + ReadStreamVByte(data, (control >> 2) & 3);
+    values[2] = values[1] + ReadStreamVByte(data, (control >> 4) & 3);
+    values[3] = values[2] + ReadStreamVByte(data,  control >> 6);
+    return data;
+}
+
+
+// Decodes a group of four neighbours at a time, which is the unit of the control bytes, and steps
+// through them. Iterators are only equal when they're at the same index of the same list, and 'end()'
+// is just the index past the last neighbour.
+class CompressedNeighbourIterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = uint32_t;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = const uint32_t*;
+    using reference         = uint32_t;
+
+    CompressedNeighbourIterator() = default;
+
+    // The end of a list of 'count' neighbours.
+    explicit CompressedNeighbourIterator(uint32_t count) : controls(nullptr), data(nullptr), values(), index(count) {}
+
+    // The start of the list of 'vertex', whose control bytes start at 'controls'. The first group is
+    // decoded right away. A group is always decoded whole, even past the end of the list, or in an
+    // empty list, where it reads the padding or the next block and is never used.
+    CompressedNeighbourIterator(uint32_t vertex, const uint8_t* controls, const uint8_t* data) :
+        controls(controls), index(0)
+    {
+        this->data = ReadStreamVByteGroup(data, *controls, 0, this->values);
+
+        // The first value is relative to the vertex rather than a gap.
+        const uint32_t shift = vertex + ZigZagDecode(this->values[0]) - this->values[0];
+        for (uint32_t& value : this->values)
+            value += shift;
+    }
+
+    uint32_t operator* () const noexcept { return this->values[this->index & 3]; }
+
+    CompressedNeighbourIterator& operator++ ()
+    {
+        if ((++this->index & 3) == 0)
+            this->data = ReadStreamVByteGroup(this->data, *++this->controls, this->values[3], this->values);
+        return *this;
+    }
+
+    CompressedNeighbourIterator operator++ (int)
+    {
+        CompressedNeighbourIterator previous = *this;
+        ++*this;
+        return previous;
+    }
+
+    bool operator== (const CompressedNeighbourIterator& other) const noexcept { return this->index == other.index; }
+    bool operator!= (const CompressedNeighbourIterator& other) const noexcept { return this->index != other.index; }
+
+private:
+    const uint8_t* controls;   // The control byte of the current group.
+    const uint8_t* data;       // The first byte after the current group.
+    uint32_t values[4];
+    uint32_t index;
+};
+
+class CompressedNeighbourList
+{
+public:
+    CompressedNeighbourList(uint32_t vertex, const uint8_t* controls, uint32_t count) :
+        controls(controls), vertex(vertex), count(count) {}
+
+    [[nodiscard]] size_t Count() const noexcept { return this->count; }
+
+    CompressedNeighbourIterator begin() const
+    {
+        return CompressedNeighbourIterator(this->vertex, this->controls, this->controls + (this->count + 3) / 4);
+    }
+    CompressedNeighbourIterator end() const noexcept { return CompressedNeighbourIterator(this->count); }
+
+private:
+    const uint8_t* controls;
+    uint32_t vertex;
+    uint32_t count;
+};
+
+
+class CompressedCsrGraph
+{
+public:
+    using VertexId = uint32_t;
+
+    // Encodes the graph in parallel, sorting the neighbours of every vertex. Duplicate edges are kept.
+    // Time Complexity: O(V + E log(E / V)), or that divided by P with P threads.
+    // Auxiliary Space: The compressed size again, while the blocks are gathered.
+    explicit CompressedCsrGraph(const CsrGraph& graph, ThreadPool& pool = ThreadPool::Global());
+
+    CompressedNeighbourList Edge(size_t i) const
+    {
+        DEBUG_BLOCK(BoundsCheck(i, size_t(0), this->vertex_count); );
+
+        const uint8_t* block = this->bytes.get() + this->offsets[i];
+        uint32_t degree = ReadDegree(block);
+        return CompressedNeighbourList(uint32_t(i), block, degree);
+    }
+
+    size_t Degree(size_t i) const
+    {
+        const uint8_t* block = this->bytes.get() + this->offsets[i];
+        return ReadDegree(block);
+    }
+
+    // Decodes all neighbours of vertex i into 'output', which must have room for 'Degree(i)' of them,
+    // and returns how many there are. Four at a time with an SSSE3 shuffle when the CPU supports it,
+    // which is faster than the iterators when the whole list is needed anyway.
+    size_t Decode(size_t i, uint32_t* output) const;
+
+    // The uncompressed graph, with every neighbour list sorted.
+    CsrGraph Decompress(ThreadPool& pool = ThreadPool::Global()) const;
+
+    size_t VertexCount() const noexcept { return this->vertex_count; }
+    size_t EdgeCount()   const noexcept { return this->edge_count;   }
+
+    // The memory taken by the offsets and the blocks.
+    size_t ByteCount() const noexcept { return (this->vertex_count + 1) * sizeof(size_t) + this->byte_count; }
+
+private:
+    // Reads the degree at the start of a block and moves 'block' past it, to the control bytes.
+    static uint32_t ReadDegree(const uint8_t*& block)
+    {
+        uint32_t degree = *block & 0x7F;
+        for (unsigned shift = 7; *block++ & 0x80; shift += 7)
+            degree |= uint32_t(*block & 0x7F) << shift;
+        return degree;
+    }
+
+    unique_ptr<size_t[]>  offsets;   // Byte offset of every block, and the end of the last one.
+    unique_ptr<uint8_t[]> bytes;
+    size_t vertex_count;
+    size_t edge_count;
+    size_t byte_count;               // Including the padding.
+};
@@ -0,0 +1,158 @@
+#include "connected_components.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <random>
+
+#include "sorting.h"
+
+
+// Points every vertex straight at its root. The whole path to the root is compressed, not just the
+// vertex itself, so the vertices further up are done by the time other tasks get to them.
+static void Compress(ThreadPool& pool, const ConcurrentUnionFind& trees, size_t vertex_count)
+{
+    ParallelFor(pool, 0, vertex_count, COMPONENTS_GRAIN_SIZE, [&trees](size_t begin, size_t end)
+    {
+        for (size_t v = begin; v < end; ++v)
+            trees.CompressPath(uint32_t(v));
+    });
+}
+
+// The most common root among a sample of vertices, which is almost surely the giant component's.
+static uint32_t SampleFrequentRoot(const ConcurrentUnionFind& trees, size_t vertex_count)
+{
+    std::mt19937_64 random(vertex_count);
+    std::uniform_int_distribution<size_t> vertex(0, vertex_count - 1);
+
+    uint32_t roots[COMPONENTS_SAMPLE_SIZE];
+    for (uint32_t& root : roots)
+        root = trees.Parent(uint32_t(vertex(random)));
+    IntroSort(roots, COMPONENTS_SAMPLE_SIZE);
+
+    uint32_t best = roots[0];
+    size_t best_count = 0;
+    for (size_t i = 0, j = 0; i < COMPONENTS_SAMPLE_SIZE; i = j)
+    {
+        while (j < COMPONENTS_SAMPLE_SIZE && roots[j] == roots[i])
+            ++j;
+        if (j - i > best_count)
+        {
+            best = roots[i];
+            best_count = j - i;
+        }
+    }
+    return best;
+}
+
+
+size_t ConnectedComponents(const CsrGraph& graph, uint32_t* components, std::vector<size_t>* sizes, ThreadPool& pool)
+{
+    const size_t    vertex_count = graph.VertexCount();
+    const size_t*   offsets      = graph.Offsets();
+    const uint32_t* neighbours   = graph.Neighbours();
+
+    if (sizes)
+        sizes->clear();
+    if (vertex_count == 0)
+        return 0;
+
+    ConcurrentUnionFind trees(vertex_count);
+
+    // Hook a few neighbours of every vertex.
+    for (size_t round = 0; round < COMPONENTS_NEIGHBOUR_ROUNDS; ++round)
+    {
+        ParallelFor(pool, 0, vertex_count, COMPONENTS_GRAIN_SIZE, [&](size_t begin, size_t end)
+        {
+            for (size_t v = begin; v < end; ++v)
+                if (offsets[v] + round < offsets[v + 1])
+                    trees.Union(uint32_t(v), neighbours[offsets[v] + round]);
+        });
+        Compress(pool, trees, vertex_count);
+    }
+
+    // Hook the rest of the edges, except those of the giant component. An edge between the giant
+    // component and another vertex still gets hooked from the other end, as the graph is undirected.
+    const uint32_t giant = SampleFrequentRoot(trees, vertex_count);
+
+    ParallelFor(pool, 0, vertex_count, COMPONENTS_GRAIN_SIZE, [&](size_t begin, size_t end)
+    {
+        for (size_t v = begin; v < end; ++v)
+        {
+            if (trees.Parent(uint32_t(v)) == giant)
+                continue;
+            for (size_t j = offsets[v] + COMPONENTS_NEIGHBOUR_ROUNDS; j < offsets[v + 1]; ++j)
+                trees.Union(uint32_t(v), neighbours[j]);
+        }
+    });
+    Compress(pool, trees, vertex_count);
+
+    // Number the roots in order, from a count of them per block of vertices.
+    const size_t block_count = (vertex_count + COMPONENTS_GRAIN_SIZE - 1) / COMPONENTS_GRAIN_SIZE;
+    auto first_labels = make_unique<size_t[]>(block_count + 1);
+
+    ParallelFor(pool, 0, block_count, 1, [&](size_t begin, size_t end)
+    {
+        for (size_t block = begin; block < end; ++block)
+        {
+            size_t roots = 0;
+            for (size_t v = block * COMPONENTS_GRAIN_SIZE; v < std::min(vertex_count, (block + 1) * COMPONENTS_GRAIN_SIZE); ++v)
+                roots += trees.Parent(uint32_t(v)) == v;
+            first_labels[block + 1] = roots;
+        }
+    });
+
+    first_labels[0] = 0;
+    for (size_t block = 0; block < block_count; ++block)
+        first_labels[block + 1] += first_labels[block];
+    const size_t component_count = first_labels[block_count];
+
+    ParallelFor(pool, 0, block_count, 1, [&](size_t begin, size_t end)
+    {
+        for (size_t block = begin; block < end; ++block)
+        {
+            size_t label = first_labels[block];
+            for (size_t v = block * COMPONENTS_GRAIN_SIZE; v < std::min(vertex_count, (block + 1) * COMPONENTS_GRAIN_SIZE); ++v)
+                if (trees.Parent(uint32_t(v)) == v)
+                    components[v] = uint32_t(label++);
+        }
+    });
+
+    ParallelFor(pool, 0, vertex_count, COMPONENTS_GRAIN_SIZE, [&](size_t begin, size_t end)
+    {
+        for (size_t v = begin; v < end; ++v)
+        {
+            uint32_t root = trees.Parent(uint32_t(v));
+            if (root != v)
+                components[v] = components[root];
+        }
+    });
+
+    if (sizes)
+    {
+        // The giant component is counted per task, so its vertices don't all hit the same counter.
+        const uint32_t giant_label = components[giant];
+        auto counts = make_unique<std::atomic<size_t>[]>(component_count);
+        for (size_t i = 0; i < component_count; ++i)
+            counts[i].store(0, std::memory_order_relaxed);
+
+        ParallelFor(pool, 0, vertex_count, COMPONENTS_GRAIN_SIZE, [&](size_t begin, size_t end)
+        {
+            size_t giant_count = 0;
+            for (size_t v = begin; v < end; ++v)
+            {
+                if (components[v] == giant_label)
+                    ++giant_count;
+                else
+                    counts[components[v]].fetch_add(1, std::memory_order_relaxed);
+            }
+            counts[giant_label].fetch_add(giant_count, std::memory_order_relaxed);
+        });
+
+        sizes->resize(component_count);
+        for (size_t i = 0; i < component_count; ++i)
+            (*sizes)[i] = counts[i].load(std::memory_order_relaxed);
+    }
+
+    return component_count;
+}
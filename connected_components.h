@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "graphs.h"
+#include "thread_pool.h"
+#include "data_structures/union_find.h"
+
+
+// Afforest (Sutton, Ben-Nun and Barak, 2018), a parallel union-find on a shared parent array.
+// https://arxiv.org/abs/1805.02226
+//
+// Every vertex starts as its own tree, and an edge is hooked with 'ConcurrentUnionFind::Union', which
+// points the root with the higher ID at the one with the lower ID with a compare-and-swap, retrying
+// when another thread got there first.
+// Since parents always have lower IDs than their children there are no cycles, and each root ends up
+// being the smallest vertex of its component. Like path compression in 'WQUPC', finds split the paths
+// they walk and the trees are flattened between rounds, so most finds are one or two hops.
+//
+// Instead of hooking every edge, the first NEIGHBOUR_ROUNDS neighbours of each vertex are hooked,
+// which on most graphs already joins nearly all of the giant component. The label of the giant
+// component is guessed from a sample of vertices, and the remaining edges are only hooked for the
+// vertices outside it, so most of the edges of the graph are never read.
+constexpr size_t   COMPONENTS_NEIGHBOUR_ROUNDS = 2;
+constexpr size_t   COMPONENTS_SAMPLE_SIZE      = 1024;
+constexpr size_t   COMPONENTS_GRAIN_SIZE       = 1 << 12;   // Vertices per task.
+
+// Fills components[0, VertexCount()) with the component of every vertex, numbered 0, 1, 2, ... in the
+// order of the smallest vertex in each component, and returns the number of components. If 'sizes'
+// isn't null, it's filled with the number of vertices in every component.
+// The graph must be undirected, i.e. have every edge in both directions. For the weakly connected
+// components of a directed graph, add the reversed edges first.
+// Time Complexity: O((V + E) α(V)), and far fewer edges are looked at in practice.
+// Auxiliary Space: O(V)
+size_t ConnectedComponents(const CsrGraph& graph, uint32_t* components, std::vector<size_t>* sizes = nullptr,
+                           ThreadPool& pool = ThreadPool::Global());
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+using std::unique_ptr;
+using std::make_unique;
+
+
+// One bit per index, packed in 64-bit words. The words are atomics so threads can share a bitmap:
+// 'Set' and 'Get' are plain (relaxed) accesses, meant for when every word has a single writer, and
+// 'TrySet' is an atomic read-modify-write for when several threads may set bits in the same word.
+class Bitmap
+{
+public:
+    constexpr static size_t BITS_PER_WORD = 64;
+
+    Bitmap() : words(), count(0), word_count(0) {}
+    explicit Bitmap(size_t count) :
+        words(make_unique<std::atomic<uint64_t>[]>(WordsFor(count))), count(count), word_count(WordsFor(count))
+    {
+        this->Clear();
+    }
+
+    bool Get(size_t i) const noexcept
+    {
+        return (this->words[i / BITS_PER_WORD].load(std::memory_order_relaxed) >> (i % BITS_PER_WORD)) & 1;
+    }
+
+    void Set(size_t i) noexcept
+    {
+        std::atomic<uint64_t>& word = this->words[i / BITS_PER_WORD];
+        word.store(word.load(std::memory_order_relaxed) | Mask(i), std::memory_order_relaxed);
+    }
+
+    // Returns true if this call is the one that set the bit.
+    bool TrySet(size_t i) noexcept
+    {
+        std::atomic<uint64_t>& word = this->words[i / BITS_PER_WORD];
+        if (word.load(std::memory_order_relaxed) & Mask(i))
+            return false;
+        return !(word.fetch_or(Mask(i), std::memory_order_relaxed) & Mask(i));
+    }
+
+    uint64_t Word(size_t w) const noexcept          { return this->words[w].load(std::memory_order_relaxed); }
+    void     SetWord(size_t w, uint64_t bits) noexcept { this->words[w].store(bits, std::memory_order_relaxed); }
+
+    void Clear() noexcept
+    {
+        for (size_t w = 0; w < this->word_count; ++w)
+            this->words[w].store(0, std::memory_order_relaxed);
+    }
+
+    void Swap(Bitmap& other) noexcept
+    {
+        std::swap(this->words,      other.words);
+        std::swap(this->count,      other.count);
+        std::swap(this->word_count, other.word_count);
+    }
+
+    [[nodiscard]] size_t Count()     const noexcept { return this->count;      }
+    [[nodiscard]] size_t WordCount() const noexcept { return this->word_count; }
+
+    static size_t WordsFor(size_t count) noexcept { return (count + BITS_PER_WORD - 1) / BITS_PER_WORD; }
+
+private:
+    static uint64_t Mask(size_t i) noexcept { return uint64_t(1) << (i % BITS_PER_WORD); }
+
+    unique_ptr<std::atomic<uint64_t>[]> words;
+    size_t count;
+    size_t word_count;
+};
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <memory>
+#include <cstring>
+#include <stdexcept>
+#include <initializer_list>
 
 using std::unique_ptr;
 using std::make_unique;
@@ -28,7 +31,7 @@ public:
 
     void Add(const T* values, size_t count)
     {
-        if (this->count + count > this->capacity)
+        while (this->count + count > this->capacity)
             this->Reallocate();
 
         for (size_t i = 0; i < count; ++i)
@@ -37,12 +40,11 @@ public:
 
     void Reallocate()
     {
-        this->capacity *= 2;
+        this->capacity = (this->capacity == 0) ? INITIAL_CAPACITY : 2 * this->capacity;
 
         auto new_storage = make_unique<T[]>(this->capacity);
         memcpy(new_storage.get(), this->data.get(), this->count * sizeof(T));
 
-        delete this->data.release();
         this->data = std::move(new_storage);
     }
 
@@ -51,6 +53,9 @@ public:
 
     [[nodiscard]] inline size_t Count() const noexcept { return this->count; }
 
+    T* begin() const noexcept { return this->data.get(); }
+    T* end()   const noexcept { return this->data.get() + this->count; }
+
     T& operator[] (size_t index) const
     {
         if (0 <= index && index < this->count)
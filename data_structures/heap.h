@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 
 #include "../utilities.h"
@@ -8,9 +10,21 @@ using std::unique_ptr;
 using std::make_unique;
 
 
-size_t GetLeftChild(size_t parent_index);
-size_t GetRightChild(size_t parent_index);
-size_t GetParent(size_t child_index);
+inline size_t GetLeftChild(size_t parent_index)
+{
+    return 2 * parent_index + 1;
+}
+inline size_t GetRightChild(size_t parent_index)
+{
+    return 2 * parent_index + 2;
+}
+inline size_t GetParent(size_t child_index)
+{
+    if (child_index == 0)
+        return 0;
+    else
+        return (child_index - 1) / 2;
+}
 
 
 template <typename T>
@@ -50,7 +64,7 @@ class MaxHeap
 {
 public:
     explicit MaxHeap(size_t max_count) : data(make_unique<T[]>(max_count)), count(0), max_count(max_count) {}
-    explicit MaxHeap(const T* array, size_t count) : data(make_unique<T[]>(count)), count(count), max_count(count)
+    explicit MaxHeap(const T* array, size_t count) : data(make_unique<T[]>(count)), count(0), max_count(count)
     {
         for (size_t i = 0; i < count; ++i)
             this->Add(array[i]);
@@ -59,9 +73,9 @@ public:
     template <class ... Targs>
     void Add(Targs&& ... args)
     {
-        ++this->count;
         if (this->count >= this->max_count)
             throw std::runtime_error("Buffer overflown");
+        ++this->count;
 
         size_t child_index      = this->count - 1;
         this->data[child_index] = T(std::forward<Targs>(args)...);
@@ -87,37 +101,201 @@ public:
         T result = this->data[index];
         Swap(&this->data[index], &this->data[this->count]);
 
-        size_t parent_index = index;
+        this->SiftDown(index);
+
+        return result;
+    }
+
+    // Replaces the largest element, which is cheaper than a 'Pop(0)' followed by an 'Add'.
+    void ReplaceTop(const T& value)
+    {
+        if (this->count == 0)
+            throw std::runtime_error("Index out of bounds.");
+
+        this->data[0] = value;
+        this->SiftDown(0);
+    }
+
+    [[nodiscard]] const T& Top() const
+    {
+        if (this->count == 0)
+            throw std::runtime_error("Index out of bounds.");
 
+        return this->data[0];
+    }
+
+    [[nodiscard]] const T* RawArray() const { return data.get(); }
+    [[nodiscard]] size_t   Count()    const { return count; }
+    [[nodiscard]] size_t   MaxCount() const { return max_count; }
+
+private:
+    void SiftDown(size_t parent_index)
+    {
         while (true)
         {
+            size_t largest_index     = parent_index;
             size_t left_child_index  = GetLeftChild(parent_index);
             size_t right_child_index = GetRightChild(parent_index);
 
-            if (left_child_index < this->count && this->data[left_child_index] > this->data[parent_index])
-            {
-                Swap(&this->data[left_child_index], &this->data[parent_index]);
-                parent_index = left_child_index;
-            }
-            else if (right_child_index < this->count && this->data[right_child_index] > this->data[parent_index])
-            {
-                Swap(&this->data[right_child_index], &this->data[parent_index]);
-                parent_index = right_child_index;
-            }
-            else
-            {
+            if (left_child_index < this->count && this->data[left_child_index] > this->data[largest_index])
+                largest_index = left_child_index;
+
+            if (right_child_index < this->count && this->data[right_child_index] > this->data[largest_index])
+                largest_index = right_child_index;
+
+            if (largest_index == parent_index)
                 break;
-            }
+
+            Swap(&this->data[largest_index], &this->data[parent_index]);
+            parent_index = largest_index;
         }
+    }
+
+    unique_ptr<T[]> data;
+    size_t count;
+    size_t max_count;
+};
+
+
+// https://en.wikipedia.org/wiki/D-ary_heap
+// Min-heap of the items 0 to max_count - 1, each with a key. It remembers where every item is, so an
+// item's key can be lowered in place ('DecreaseKey') instead of adding a duplicate. With D children
+// per node the heap is log2(D) times shallower than a binary one, which makes the (frequent) decrease
+// keys cheaper, while popping compares up to D children per level that sit next to each other in memory.
+// Sifting moves the hole instead of swapping, and the keys are kept apart from the items so the
+// comparisons only read keys.
+// Time Complexity: O(log_D n) 'Push' and 'DecreaseKey', O(D log_D n) 'Pop'.
+// Auxiliary Space: O(max_count)
+template <class K, size_t D = 4>
+class IndexedMinHeap
+{
+public:
+    static_assert(D >= 2, "A heap needs at least two children per node.");
+
+    constexpr static uint32_t NOT_IN_HEAP = UINT32_MAX;
+
+    explicit IndexedMinHeap(size_t max_count) :
+        keys(make_unique<K[]>(max_count)), items(make_unique<uint32_t[]>(max_count)),
+        positions(make_unique<uint32_t[]>(max_count)), count(0), max_count(max_count)
+    {
+        if (max_count > size_t(NOT_IN_HEAP))
+            throw std::runtime_error("Too many items for 32-bit indices.");
+
+        for (size_t i = 0; i < max_count; ++i)
+            this->positions[i] = NOT_IN_HEAP;
+    }
+
+    void Push(uint32_t item, const K& key)
+    {
+        if (item >= this->max_count || this->Contains(item))
+            throw std::runtime_error("Item is out of range or already in the heap.");
+
+        this->SiftUp(this->count++, item, key);
+    }
+
+    // 'key' must not be larger than the item's current key.
+    void DecreaseKey(uint32_t item, const K& key)
+    {
+        if (item >= this->max_count)
+            throw std::runtime_error("Item is out of range.");
+        if (!this->Contains(item))
+            throw std::runtime_error("Item isn't in the heap.");
+
+        this->SiftUp(this->positions[item], item, key);
+    }
+
+    void PushOrDecreaseKey(uint32_t item, const K& key)
+    {
+        if (item >= this->max_count)
+            throw std::runtime_error("Item is out of range.");
+
+        if (this->Contains(item))
+            this->DecreaseKey(item, key);
+        else
+            this->Push(item, key);
+    }
+
+    // Removes and returns the item with the smallest key.
+    uint32_t Pop()
+    {
+        if (this->count == 0)
+            throw std::runtime_error("Index out of bounds.");
+
+        uint32_t result = this->items[0];
+        this->positions[result] = NOT_IN_HEAP;
+
+        if (--this->count > 0)
+            this->SiftDown(0, this->items[this->count], this->keys[this->count]);
 
         return result;
     }
 
-    [[nodiscard]] const T* RawArray() const { return data.get(); }
-    [[nodiscard]] size_t   Count()    const { return count; }
+    [[nodiscard]] uint32_t Top()    const { return this->items[0]; }
+    [[nodiscard]] const K& TopKey() const { return this->keys[0];  }
+
+    [[nodiscard]] bool Contains(uint32_t item) const noexcept { return item < this->max_count && this->positions[item] != NOT_IN_HEAP; }
+    [[nodiscard]] bool IsEmpty()  const noexcept { return this->count == 0;   }
+    [[nodiscard]] size_t Count()    const noexcept { return this->count;     }
+    [[nodiscard]] size_t MaxCount() const noexcept { return this->max_count; }
+
+    // Only touches the items that are in the heap, so a heap can be reused cheaply.
+    void Clear() noexcept
+    {
+        for (size_t i = 0; i < this->count; ++i)
+            this->positions[this->items[i]] = NOT_IN_HEAP;
+        this->count = 0;
+    }
 
 private:
-    unique_ptr<T[]> data;
+    void Place(size_t index, uint32_t item, const K& key)
+    {
+        this->keys[index]     = key;
+        this->items[index]    = item;
+        this->positions[item] = uint32_t(index);
+    }
+
+    void SiftUp(size_t index, uint32_t item, const K& key)
+    {
+        while (index > 0)
+        {
+            size_t parent = (index - 1) / D;
+            if (!(key < this->keys[parent]))
+                break;
+
+            this->Place(index, this->items[parent], this->keys[parent]);
+            index = parent;
+        }
+
+        this->Place(index, item, key);
+    }
+
+    void SiftDown(size_t index, uint32_t item, const K& key)
+    {
+        while (true)
+        {
+            size_t first_child = D * index + 1;
+            if (first_child >= this->count)
+                break;
+
+            size_t last_child     = std::min(first_child + D, this->count);
+            size_t smallest_child = first_child;
+            for (size_t child = first_child + 1; child < last_child; ++child)
+                if (this->keys[child] < this->keys[smallest_child])
+                    smallest_child = child;
+
+            if (!(this->keys[smallest_child] < key))
+                break;
+
+            this->Place(index, this->items[smallest_child], this->keys[smallest_child]);
+            index = smallest_child;
+        }
+
+        this->Place(index, item, key);
+    }
+
+    unique_ptr<K[]>        keys;
+    unique_ptr<uint32_t[]> items;
+    unique_ptr<uint32_t[]> positions;
     size_t count;
     size_t max_count;
 };
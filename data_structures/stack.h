@@ -4,6 +4,8 @@
 #pragma once
 
 #include <memory>
+#include <stdexcept>
+#include <initializer_list>
 
 #include "../debug.h"
 
@@ -27,7 +29,7 @@ public:
     {
         size_t i = 0;
         for (auto it = data.begin(); it != data.end(); ++it)
-            this->data[i] = *it;
+            this->data[i++] = *it;
     }
 
     bool IsFull()  const noexcept { return this->count == this->capacity; }
@@ -45,15 +47,22 @@ public:
     {
         DEBUG_BLOCK(if (IsEmpty()) throw std::runtime_error("Queue is already empty."); );
 
-        T& result = this->data[this->count--];
+        T& result = this->data[--this->count];
         return result;
     }
 
+    T& Top()
+    {
+        DEBUG_BLOCK(if (IsEmpty()) throw std::runtime_error("Stack is empty."); );
+
+        return this->data[this->count - 1];
+    }
+
     size_t Count() const noexcept { return this->count; }
 
 
 private:
     unique_ptr<T[]> data;
-    size_t capacity;
     size_t count;
+    size_t capacity;
 };
\ No newline at end of file
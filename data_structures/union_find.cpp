@@ -1,207 +1,8 @@
 #include "union_find.h"
 
-#include <memory>
 #include <iostream>
-
-
-using std::unique_ptr;
-using std::make_unique;
-
-
-class QuickFind
-{
-public:
-    const size_t capacity;
-
-    explicit QuickFind(size_t capacity) : capacity(capacity), id(make_unique<size_t[]>(capacity))
-    {
-        for (size_t i = 0; i < capacity; ++i)
-            this->id[i] = i;
-    }
-
-    [[nodiscard]]
-    inline bool Connected(size_t a, size_t b) const noexcept { return this->id[a] == this->id[b]; }
-
-    void Union(size_t a, size_t b) const noexcept
-    {
-        size_t id_a = this->id[a];
-        size_t id_b = this->id[b];
-
-        for (size_t i = 0; i < capacity; ++i)
-            if (this->id[i] == id_b)
-                this->id[i] = id_a;
-    }
-
-private:
-    unique_ptr<size_t[]> id;
-};
-
-
-class QuickUnion
-{
-public:
-    const size_t capacity;
-
-    explicit QuickUnion(size_t capacity) : capacity(capacity), id(make_unique<size_t[]>(capacity))
-    {
-        for (size_t i = 0; i < capacity; ++i)
-            this->id[i] = i;
-    }
-
-    [[nodiscard]]
-    inline bool Connected(size_t a, size_t b) const noexcept
-    {
-        size_t root_a = FindRoot(a);
-        size_t root_b = FindRoot(b);
-
-        return root_a == root_b;
-    }
-
-    void Union(size_t a, size_t b) const noexcept
-    {
-        size_t root_a = FindRoot(a);
-        this->id[b] = root_a;
-    }
-
-private:
-    [[nodiscard]]
-    size_t FindRoot(size_t node) const
-    {
-        size_t parent = this->id[node];
-        while (parent != node)
-        {
-            node = parent;
-            parent = this->id[parent];
-        }
-        return node;
-    }
-
-
-    unique_ptr<size_t[]> id;
-};
-
-
-class WeightedUnion
-{
-public:
-    const size_t capacity;
-
-    explicit WeightedUnion(size_t capacity) : capacity(capacity), id(make_unique<size_t[]>(capacity)), tree_size(make_unique<size_t[]>(capacity))
-    {
-        for (size_t i = 0; i < capacity; ++i)
-        {
-            this->id[i] = i;
-            this->tree_size[i] = 1;
-        }
-    }
-
-    [[nodiscard]]
-    inline bool Connected(size_t a, size_t b) const noexcept
-    {
-        size_t root_a = FindRoot(a);
-        size_t root_b = FindRoot(b);
-
-        return root_a == root_b;
-    }
-
-    void Union(size_t a, size_t b) const noexcept
-    {
-        size_t root_a = FindRoot(a);
-        size_t root_b = FindRoot(b);
-
-        if (root_a == root_b)
-            return;
-
-        if (this->tree_size[root_a] > this->tree_size[root_b])
-        {
-            this->id[b] = root_a;
-            this->tree_size[root_a] += this->tree_size[root_b];
-        }
-        else
-        {
-            this->id[a] = root_b;
-            this->tree_size[root_b] += this->tree_size[root_a];
-        }
-    }
-
-private:
-    [[nodiscard]]
-    size_t FindRoot(size_t node) const
-    {
-        size_t parent = this->id[node];
-        while (parent != node)
-        {
-            node = parent;
-            parent = this->id[parent];
-        }
-        return node;
-    }
-
-
-    unique_ptr<size_t[]> id;
-    unique_ptr<size_t[]> tree_size;
-};
-
-
-class WQUPC  // Weighted Quick Union with Path Compression
-{
-public:
-    const size_t capacity;
-
-    explicit WQUPC(size_t capacity) : capacity(capacity), id(make_unique<size_t[]>(capacity)), tree_size(make_unique<size_t[]>(capacity))
-    {
-        for (size_t i = 0; i < capacity; ++i)
-        {
-            this->id[i] = i;
-            this->tree_size[i] = 1;
-        }
-    }
-
-    [[nodiscard]]
-    inline bool Connected(size_t a, size_t b) const noexcept
-    {
-        size_t root_a = FindRoot(a);
-        size_t root_b = FindRoot(b);
-
-        return root_a == root_b;
-    }
-
-    void Union(size_t a, size_t b) const noexcept
-    {
-        size_t root_a = FindRoot(a);
-        size_t root_b = FindRoot(b);
-
-        if (root_a == root_b)
-            return;
-
-        if (this->tree_size[root_a] > this->tree_size[root_b])
-        {
-            this->id[b] = root_a;
-            this->tree_size[root_a] += this->tree_size[root_b];
-        }
-        else
-        {
-            this->id[a] = root_b;
-            this->tree_size[root_b] += this->tree_size[root_a];
-        }
-    }
-
-private:
-    [[nodiscard]]
-    size_t FindRoot(size_t node) const
-    {
-        while (node != this->id[node])
-        {
-            this->id[node] = this->id[this->id[node]];  // Path compression.
-            node = this->id[node];
-        }
-        return node;
-    }
-
-
-    unique_ptr<size_t[]> id;
-    unique_ptr<size_t[]> tree_size;
-};
+#include <thread>
+#include <vector>
 
 
 template <class Union>
@@ -237,10 +38,39 @@ void TestUnion()
 
 
 
+// Every thread joins every 'thread_count'th pair of neighbours in a chain, so the chain is only
+// connected once all of them are done, and asks about pairs the others are joining meanwhile.
+void TestConcurrentUnion(size_t thread_count)
+{
+    constexpr uint32_t COUNT = 1 << 20;
+    ConcurrentUnionFind union_find(COUNT);
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < thread_count; ++t)
+        threads.emplace_back([&union_find, t, thread_count]()
+        {
+            for (uint32_t i = uint32_t(t); i + 1 < COUNT; i += uint32_t(thread_count))
+            {
+                union_find.Union(i, i + 1);
+                (void) union_find.Connected(i, COUNT - 1 - i);
+            }
+        });
+    for (std::thread& thread : threads)
+        thread.join();
+
+    std::cout << "Concurrent, " << thread_count << " threads: " << union_find.Connected(0, COUNT - 1) << "\n\n";
+}
+
+
 int main()
 {
     TestUnion<QuickFind>();
     TestUnion<QuickUnion>();
     TestUnion<WeightedUnion>();
     TestUnion<WQUPC>();
+    TestUnion<ConcurrentUnionFind>();
+    TestUnion<CompactUnionFind<>>();
+    TestUnion<CompactUnionFind<uint64_t>>();
+
+    TestConcurrentUnion(4);
 }
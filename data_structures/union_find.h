@@ -1,2 +1,389 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+using std::unique_ptr;
+using std::make_unique;
+
+
+// Every 'Union' returns false if 'a' and 'b' were already connected.
+class QuickFind
+{
+public:
+    const size_t capacity;
+
+    explicit QuickFind(size_t capacity) : capacity(capacity), id(make_unique<size_t[]>(capacity))
+    {
+        for (size_t i = 0; i < capacity; ++i)
+            this->id[i] = i;
+    }
+
+    [[nodiscard]]
+    inline bool Connected(size_t a, size_t b) const noexcept { return this->id[a] == this->id[b]; }
+
+    bool Union(size_t a, size_t b) const noexcept
+    {
+        size_t id_a = this->id[a];
+        size_t id_b = this->id[b];
+
+        if (id_a == id_b)
+            return false;
+
+        for (size_t i = 0; i < capacity; ++i)
+            if (this->id[i] == id_b)
+                this->id[i] = id_a;
+        return true;
+    }
+
+private:
+    unique_ptr<size_t[]> id;
+};
+
+
+class QuickUnion
+{
+public:
+    const size_t capacity;
+
+    explicit QuickUnion(size_t capacity) : capacity(capacity), id(make_unique<size_t[]>(capacity))
+    {
+        for (size_t i = 0; i < capacity; ++i)
+            this->id[i] = i;
+    }
+
+    [[nodiscard]]
+    inline bool Connected(size_t a, size_t b) const noexcept
+    {
+        size_t root_a = FindRoot(a);
+        size_t root_b = FindRoot(b);
+
+        return root_a == root_b;
+    }
+
+    bool Union(size_t a, size_t b) const noexcept
+    {
+        size_t root_a = FindRoot(a);
+        size_t root_b = FindRoot(b);
+
+        if (root_a == root_b)
+            return false;
+
+        this->id[root_b] = root_a;
+        return true;
+    }
+
+private:
+    [[nodiscard]]
+    size_t FindRoot(size_t node) const
+    {
+        size_t parent = this->id[node];
+        while (parent != node)
+        {
+            node = parent;
+            parent = this->id[parent];
+        }
+        return node;
+    }
+
+
+    unique_ptr<size_t[]> id;
+};
+
+
+class WeightedUnion
+{
+public:
+    const size_t capacity;
+
+    explicit WeightedUnion(size_t capacity) : capacity(capacity), id(make_unique<size_t[]>(capacity)), tree_size(make_unique<size_t[]>(capacity))
+    {
+        for (size_t i = 0; i < capacity; ++i)
+        {
+            this->id[i] = i;
+            this->tree_size[i] = 1;
+        }
+    }
+
+    [[nodiscard]]
+    inline bool Connected(size_t a, size_t b) const noexcept
+    {
+        size_t root_a = FindRoot(a);
+        size_t root_b = FindRoot(b);
+
+        return root_a == root_b;
+    }
+
+    bool Union(size_t a, size_t b) const noexcept
+    {
+        size_t root_a = FindRoot(a);
+        size_t root_b = FindRoot(b);
+
+        if (root_a == root_b)
+            return false;
+
+        if (this->tree_size[root_a] > this->tree_size[root_b])
+        {
+            this->id[root_b] = root_a;
+            this->tree_size[root_a] += this->tree_size[root_b];
+        }
+        else
+        {
+            this->id[root_a] = root_b;
+            this->tree_size[root_b] += this->tree_size[root_a];
+        }
+        return true;
+    }
+
+private:
+    [[nodiscard]]
+    size_t FindRoot(size_t node) const
+    {
+        size_t parent = this->id[node];
+        while (parent != node)
+        {
+            node = parent;
+            parent = this->id[parent];
+        }
+        return node;
+    }
+
+
+    unique_ptr<size_t[]> id;
+    unique_ptr<size_t[]> tree_size;
+};
+
+
+class WQUPC  // Weighted Quick Union with Path Compression
+{
+public:
+    const size_t capacity;
+
+    explicit WQUPC(size_t capacity) : capacity(capacity), id(make_unique<size_t[]>(capacity)), tree_size(make_unique<size_t[]>(capacity))
+    {
+        for (size_t i = 0; i < capacity; ++i)
+        {
+            this->id[i] = i;
+            this->tree_size[i] = 1;
+        }
+    }
+
+    [[nodiscard]]
+    inline bool Connected(size_t a, size_t b) const noexcept
+    {
+        size_t root_a = FindRoot(a);
+        size_t root_b = FindRoot(b);
+
+        return root_a == root_b;
+    }
+
+    bool Union(size_t a, size_t b) const noexcept
+    {
+        size_t root_a = FindRoot(a);
+        size_t root_b = FindRoot(b);
+
+        if (root_a == root_b)
+            return false;
+
+        if (this->tree_size[root_a] > this->tree_size[root_b])
+        {
+            this->id[root_b] = root_a;
+            this->tree_size[root_a] += this->tree_size[root_b];
+        }
+        else
+        {
+            this->id[root_a] = root_b;
+            this->tree_size[root_b] += this->tree_size[root_a];
+        }
+        return true;
+    }
+
+    [[nodiscard]]
+    size_t FindRoot(size_t node) const
+    {
+        while (node != this->id[node])
+        {
+            this->id[node] = this->id[this->id[node]];  // Path compression.
+            node = this->id[node];
+        }
+        return node;
+    }
+
+private:
+
+    unique_ptr<size_t[]> id;
+    unique_ptr<size_t[]> tree_size;
+};
+
+
+// A union-find that any number of threads can use at once, without locks.
+// https://arxiv.org/abs/1911.06347
+// The parents are atomics, and only a root is ever linked, with a compare-and-swap that fails if it
+// isn't a root anymore, so two threads can't link the same root into two trees. 'Union' links the
+// root with the higher index below the other, which can't make a cycle, and starts over from the new
+// roots if it lost a race. 'FindRoot' does path splitting, pointing every node on the way at its
+// grandparent, with a compare-and-swap that's simply dropped if another thread changed the node first.
+// It never waits for another thread, and as a node's ancestors stay its ancestors, it can't undo a link.
+// Indices are 32-bit, so it takes 4 bytes per element.
+class ConcurrentUnionFind
+{
+public:
+    const size_t capacity;
+
+    explicit ConcurrentUnionFind(size_t capacity) : capacity(capacity), parent(make_unique<std::atomic<uint32_t>[]>(capacity))
+    {
+        if (capacity > size_t(UINT32_MAX))
+            throw std::runtime_error("ConcurrentUnionFind only supports 32-bit indices.");
+
+        for (size_t i = 0; i < capacity; ++i)
+            this->parent[i].store(uint32_t(i), std::memory_order_relaxed);
+    }
+
+    // Racing a 'Union' it returns true if the two were connected before it, false if they weren't
+    // connected after it, and either of the two in between. Only a root is checked for a new parent.
+    [[nodiscard]]
+    bool Connected(uint32_t a, uint32_t b) const noexcept
+    {
+        while (true)
+        {
+            a = this->FindRoot(a);
+            b = this->FindRoot(b);
+
+            if (a == b)
+                return true;
+            if (this->Parent(a) == a)
+                return false;
+        }
+    }
+
+    bool Union(uint32_t a, uint32_t b) noexcept
+    {
+        while (true)
+        {
+            a = this->FindRoot(a);
+            b = this->FindRoot(b);
+
+            if (a == b)
+                return false;
+            if (a < b)
+                std::swap(a, b);
+
+            uint32_t expected = a;
+            if (this->parent[a].compare_exchange_strong(expected, b, std::memory_order_acq_rel, std::memory_order_acquire))
+                return true;
+        }
+    }
+
+    // Only shortens paths, which doesn't change any set, so it's const like 'Connected'.
+    [[nodiscard]]
+    uint32_t FindRoot(uint32_t node) const noexcept
+    {
+        while (true)
+        {
+            uint32_t parent      = this->Parent(node);
+            uint32_t grandparent = this->Parent(parent);
+            if (parent == grandparent)
+                return parent;
+
+            this->parent[node].compare_exchange_weak(parent, grandparent, std::memory_order_relaxed);
+            node = grandparent;
+        }
+    }
+
+    // Points 'node' and every node above it straight at the root, to flatten the trees between rounds
+    // of unions. It can run alongside 'FindRoot' and other compressions, which all write the same
+    // roots, but not alongside 'Union': once the root it found is linked, it could point the new root
+    // back at it.
+    void CompressPath(uint32_t node) const noexcept
+    {
+        uint32_t root = node;
+        uint32_t parent;
+        while (root != (parent = this->Parent(root)))
+            root = parent;
+
+        while ((parent = this->Parent(node)) != root)
+        {
+            this->parent[node].store(root, std::memory_order_relaxed);
+            node = parent;
+        }
+    }
+
+    // The node itself if it's a root.
+    [[nodiscard]]
+    uint32_t Parent(uint32_t node) const noexcept { return this->parent[node].load(std::memory_order_acquire); }
+
+private:
+    unique_ptr<std::atomic<uint32_t>[]> parent;
+};
+
+
+// Union by rank with path halving, in a single array of 'Index' per element: a root keeps its rank in
+// its own entry, marked by the top bit, and any other element keeps its parent. That's 4 bytes per
+// element with 32-bit indices, a quarter of 'WQUPC', and every step of a find reads one entry, i.e.
+// one cache line, where 'WQUPC' also reads the tree sizes from another array when it unites.
+// The ranks never exceed log2(capacity), so they fit easily below the mark. Take 64-bit indices for
+// more than 2^31 elements.
+template <class Index = uint32_t>
+class CompactUnionFind
+{
+public:
+    static_assert(std::is_unsigned_v<Index>, "The indices must be unsigned.");
+
+    constexpr static Index ROOT = Index(1) << (8 * sizeof(Index) - 1);   // Marks a root; the rest is its rank.
+
+    const size_t capacity;
+
+    explicit CompactUnionFind(size_t capacity) : capacity(capacity)
+    {
+        if (capacity > size_t(ROOT))
+            throw std::runtime_error("Too many elements for the index type.");
+
+        this->entry = unique_ptr<Index[]>(new Index[capacity]);
+        for (size_t i = 0; i < capacity; ++i)
+            this->entry[i] = ROOT;
+    }
+
+    [[nodiscard]]
+    bool Connected(Index a, Index b) noexcept { return this->FindRoot(a) == this->FindRoot(b); }
+
+    bool Union(Index a, Index b) noexcept
+    {
+        a = this->FindRoot(a);
+        b = this->FindRoot(b);
+
+        if (a == b)
+            return false;
+
+        // The rank is only kept below the mark, so the larger entry has the larger rank.
+        if (this->entry[a] < this->entry[b])
+            std::swap(a, b);
+        if (this->entry[a] == this->entry[b])
+            this->entry[a] += 1;
+        this->entry[b] = a;
+        return true;
+    }
+
+    // Path halving: every other element on the way is pointed at its grandparent.
+    [[nodiscard]]
+    Index FindRoot(Index node) noexcept
+    {
+        while (!(this->entry[node] & ROOT))
+        {
+            Index parent = this->entry[node];
+            if (this->entry[parent] & ROOT)
+                return parent;
+
+            this->entry[node] = this->entry[parent];
+            node = this->entry[parent];
+        }
+        return node;
+    }
+
+private:
+    unique_ptr<Index[]> entry;
+};
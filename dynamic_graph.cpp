@@ -0,0 +1,261 @@
+#include "dynamic_graph.h"
+
+#include <algorithm>
+
+#include "sorting.h"
+
+
+static uint64_t EdgeKey(const CsrEdge& edge)
+{
+    return (uint64_t(edge.source) << 32) | edge.target;
+}
+
+// The batch sorted by source and then target, without duplicates.
+static std::vector<CsrEdge> SortBatch(const CsrEdge* edges, size_t count, size_t vertex_count)
+{
+    std::vector<CsrEdge> batch(edges, edges + count);
+    for (const CsrEdge& edge : batch)
+        if (edge.source >= vertex_count || edge.target >= vertex_count)
+            throw std::runtime_error("Edge refers to a vertex that doesn't exist.");
+
+    RadixSortBy(batch.data(), batch.size(), EdgeKey);
+    batch.erase(std::unique(batch.begin(), batch.end(), [](const CsrEdge& a, const CsrEdge& b) { return EdgeKey(a) == EdgeKey(b); }),
+                batch.end());
+    return batch;
+}
+
+// Merges the sorted list 'old' without the targets of 'deleted' and with those of 'inserted', which
+// are sorted too. Writes the result to 'output' unless it's null, and returns its length.
+static size_t MergeList(const uint32_t* old, size_t old_count, const CsrEdge* deleted, size_t deleted_count,
+                        const CsrEdge* inserted, size_t inserted_count, uint32_t* output)
+{
+    size_t i = 0, d = 0, n = 0, count = 0;
+
+    while (i < old_count || n < inserted_count)
+    {
+        uint32_t next;
+        if (n == inserted_count || (i < old_count && old[i] < inserted[n].target))
+        {
+            next = old[i++];
+
+            while (d < deleted_count && deleted[d].target < next)
+                ++d;
+            if (d < deleted_count && deleted[d].target == next)
+                continue;
+        }
+        else
+        {
+            next = inserted[n++].target;
+            if (i < old_count && old[i] == next)
+                ++i;
+        }
+
+        if (output)
+            output[count] = next;
+        ++count;
+    }
+
+    return count;
+}
+
+
+DynamicGraph::DynamicGraph(size_t vertex_count) :
+    vertex_count(vertex_count), edge_count(0), component_count(vertex_count), components_stale(false)
+{
+    // The IDs are 32-bit, and so are the indices of the union-find, which needs one bit for its roots.
+    if (vertex_count > size_t(UnionFind::ROOT))
+        throw std::runtime_error("DynamicGraph only supports up to 2^31 vertices.");
+
+    this->ranges.resize(vertex_count);
+    this->components = make_unique<UnionFind>(vertex_count);
+    this->neighbours.resize(this->CompactSize());
+    for (size_t v = 0; v < vertex_count; ++v)
+        this->ranges[v] = { v * DYNAMIC_GRAPH_MIN_ROOM, 0, DYNAMIC_GRAPH_MIN_ROOM };
+}
+
+DynamicGraph::DynamicGraph(const CsrGraph& graph, ThreadPool& pool) : DynamicGraph(graph.VertexCount())
+{
+    std::vector<size_t> degrees(this->vertex_count);
+
+    // Sort and deduplicate every list in place, then lay them out with 'Compact'.
+    std::vector<uint32_t> lists(graph.Neighbours(), graph.Neighbours() + graph.EdgeCount());
+    ParallelFor(pool, 0, this->vertex_count, DYNAMIC_GRAPH_GRAIN_SIZE, [&](size_t begin, size_t end)
+    {
+        for (size_t v = begin; v < end; ++v)
+        {
+            uint32_t* list = lists.data() + graph.Offsets()[v];
+            size_t    size = graph.Degree(v);
+
+            IntroSort(list, size);
+            degrees[v] = size_t(std::unique(list, list + size) - list);
+        }
+    });
+
+    for (size_t v = 0; v < this->vertex_count; ++v)
+    {
+        this->ranges[v] = { graph.Offsets()[v], uint32_t(degrees[v]), uint32_t(degrees[v]) };
+        this->edge_count += degrees[v];
+    }
+    this->neighbours = std::move(lists);
+
+    this->Compact(pool);
+    this->components_stale = true;
+}
+
+
+uint32_t DynamicGraph::RoomFor(size_t degree)
+{
+    // The degree is at most the number of vertices, so only the slack can go past 32 bits.
+    return uint32_t(std::min<size_t>(UINT32_MAX, degree + degree / 2 + DYNAMIC_GRAPH_MIN_ROOM));
+}
+
+void DynamicGraph::Compact(ThreadPool& pool)
+{
+    std::vector<Range> compacted(this->vertex_count);
+
+    size_t offset = 0;
+    for (size_t v = 0; v < this->vertex_count; ++v)
+    {
+        compacted[v] = { offset, this->ranges[v].degree, RoomFor(this->ranges[v].degree) };
+        offset += compacted[v].room;
+    }
+
+    std::vector<uint32_t> moved(offset);
+    ParallelFor(pool, 0, this->vertex_count, DYNAMIC_GRAPH_GRAIN_SIZE, [&](size_t begin, size_t end)
+    {
+        for (size_t v = begin; v < end; ++v)
+            std::copy_n(this->neighbours.data() + this->ranges[v].offset, this->ranges[v].degree, moved.data() + compacted[v].offset);
+    });
+
+    this->neighbours = std::move(moved);
+    this->ranges     = std::move(compacted);
+}
+
+
+void DynamicGraph::Update(const CsrEdge* insertions, size_t insertion_count, const CsrEdge* deletions, size_t deletion_count,
+                          ThreadPool& pool)
+{
+    const std::vector<CsrEdge> inserted = SortBatch(insertions, insertion_count, this->vertex_count);
+    const std::vector<CsrEdge> deleted  = SortBatch(deletions,  deletion_count,  this->vertex_count);
+
+    // Every vertex with updates, with its runs of them in both batches.
+    struct Change
+    {
+        uint32_t vertex;
+        uint32_t degree;   // After the update.
+        size_t   inserted_begin, inserted_end;
+        size_t   deleted_begin,  deleted_end;
+        size_t   offset;   // Where the merged list goes.
+    };
+
+    std::vector<Change> changes;
+    for (size_t i = 0, d = 0; i < inserted.size() || d < deleted.size(); )
+    {
+        const uint32_t vertex = std::min(i < inserted.size() ? inserted[i].source : UINT32_MAX,
+                                         d < deleted.size()  ? deleted[d].source  : UINT32_MAX);
+        Change change = { vertex, 0, i, i, d, d, this->ranges[vertex].offset };
+
+        while (change.inserted_end < inserted.size() && inserted[change.inserted_end].source == vertex)
+            ++change.inserted_end;
+        while (change.deleted_end < deleted.size() && deleted[change.deleted_end].source == vertex)
+            ++change.deleted_end;
+
+        i = change.inserted_end;
+        d = change.deleted_end;
+        changes.push_back(change);
+    }
+
+    auto merge = [&](const Change& change, uint32_t* output)
+    {
+        const Range& range = this->ranges[change.vertex];
+        return MergeList(this->neighbours.data() + range.offset, range.degree,
+                         deleted.data()  + change.deleted_begin,  change.deleted_end  - change.deleted_begin,
+                         inserted.data() + change.inserted_begin, change.inserted_end - change.inserted_begin, output);
+    };
+
+    ParallelFor(pool, 0, changes.size(), DYNAMIC_GRAPH_GRAIN_SIZE, [&](size_t begin, size_t end)
+    {
+        for (size_t c = begin; c < end; ++c)
+            changes[c].degree = uint32_t(merge(changes[c], nullptr));
+    });
+
+    // The lists that don't fit in their room anymore move to the end of the array.
+    size_t size = this->neighbours.size();
+    for (Change& change : changes)
+    {
+        Range& range = this->ranges[change.vertex];
+        this->edge_count += change.degree;
+        this->edge_count -= range.degree;
+
+        if (change.degree > range.room)
+        {
+            change.offset = size;
+            range.room    = std::max(RoomFor(change.degree), uint32_t(std::min<size_t>(UINT32_MAX, 2 * size_t(range.room))));
+            size += range.room;
+        }
+    }
+    this->neighbours.resize(size);
+
+    // Every list is merged into a buffer first, as it may go back where it's read from. The lists
+    // that moved are still read from where they were.
+    ParallelFor(pool, 0, changes.size(), DYNAMIC_GRAPH_GRAIN_SIZE, [&](size_t begin, size_t end)
+    {
+        std::vector<uint32_t> buffer;
+        for (size_t c = begin; c < end; ++c)
+        {
+            buffer.resize(changes[c].degree);
+            merge(changes[c], buffer.data());
+            std::copy(buffer.begin(), buffer.end(), this->neighbours.data() + changes[c].offset);
+        }
+    });
+
+    for (const Change& change : changes)
+    {
+        this->ranges[change.vertex].offset = change.offset;
+        this->ranges[change.vertex].degree = change.degree;
+    }
+
+    if (this->neighbours.size() > 2 * this->CompactSize())
+        this->Compact(pool);
+
+    // An edge whose ends are connected already doesn't change the components, so it doesn't matter
+    // whether it was in the graph before.
+    if (!deleted.empty())
+        this->components_stale = true;
+    if (!this->components_stale)
+        for (const CsrEdge& edge : inserted)
+            this->component_count -= this->components->Union(edge.source, edge.target);
+}
+
+
+bool DynamicGraph::HasEdge(uint32_t source, uint32_t target) const
+{
+    NeighbourList list = this->Edge(source);
+    return std::binary_search(list.begin(), list.end(), target);
+}
+
+void DynamicGraph::RebuildComponents()
+{
+    this->components      = make_unique<UnionFind>(this->vertex_count);
+    this->component_count = this->vertex_count;
+
+    for (size_t v = 0; v < this->vertex_count; ++v)
+        for (uint32_t neighbour : this->Edge(v))
+            this->component_count -= this->components->Union(v, neighbour);
+
+    this->components_stale = false;
+}
+
+bool DynamicGraph::Connected(uint32_t a, uint32_t b)
+{
+    if (this->components_stale)
+        this->RebuildComponents();
+    return this->components->Connected(a, b);
+}
+
+size_t DynamicGraph::ComponentCount()
+{
+    if (this->components_stale)
+        this->RebuildComponents();
+    return this->component_count;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "graphs.h"
+#include "thread_pool.h"
+#include "data_structures/union_find.h"
+
+
+// A graph whose edges change in batches, with its connected components kept up to date.
+// https://en.wikipedia.org/wiki/Dynamic_connectivity
+//
+// The layout is CSR with slack: every vertex owns a range of one neighbour array, with room for more
+// neighbours than it has, and keeps its neighbours sorted in it. A batch of updates is sorted by
+// source, so every vertex merges all of its updates into its list in one pass, and the vertices are
+// merged in parallel. A vertex that outgrows its room moves to the end of the array with twice as much,
+// and once the array is more than twice the size it would be compacted, it's compacted in vertex order.
+// The lists stay contiguous, so 'Edge' returns the same 'NeighbourList' as 'CsrGraph' and the searches
+// in graphs.h read them just as fast.
+//
+// The edges are a set: inserting an edge that's there, or deleting one that isn't, does nothing. The
+// components are those of the undirected graph, i.e. the direction of an edge doesn't matter for them.
+// Insertions can only merge components, so they're added to a union-find as they come. A deletion can
+// split one, which a union-find can't undo, so after a batch with deletions the components are
+// rebuilt from all the edges, once, on the next query.
+// Memory: 16 * V bytes of ranges, 4 bytes per unit of room, and 4 * V bytes for the union-find.
+constexpr size_t   DYNAMIC_GRAPH_GRAIN_SIZE = 1 << 10;   // Updated vertices per task.
+constexpr uint32_t DYNAMIC_GRAPH_MIN_ROOM   = 4;         // Room every vertex gets on top of 1.5 times its degree.
+
+class DynamicGraph
+{
+public:
+    using VertexId = uint32_t;
+
+    explicit DynamicGraph(size_t vertex_count);
+
+    // Copies the edges of 'graph', without its duplicates.
+    explicit DynamicGraph(const CsrGraph& graph, ThreadPool& pool = ThreadPool::Global());
+
+    // Deletes the edges in 'deletions', then inserts the ones in 'insertions'.
+    // Time Complexity: O(B log B) to sort the batch of B updates, plus the degrees of the updated
+    //                  vertices to merge them, in parallel.
+    // Auxiliary Space: O(B)
+    void Update(const CsrEdge* insertions, size_t insertion_count, const CsrEdge* deletions, size_t deletion_count,
+                ThreadPool& pool = ThreadPool::Global());
+
+    void Insert(const CsrEdge* edges, size_t count, ThreadPool& pool = ThreadPool::Global()) { this->Update(edges, count, nullptr, 0, pool); }
+    void Delete(const CsrEdge* edges, size_t count, ThreadPool& pool = ThreadPool::Global()) { this->Update(nullptr, 0, edges, count, pool); }
+
+    // The sorted neighbours of vertex i, until the next update.
+    NeighbourList Edge(size_t i) const
+    {
+        DEBUG_BLOCK(BoundsCheck(i, size_t(0), this->vertex_count); );
+        return NeighbourList(this->neighbours.data() + this->ranges[i].offset, this->ranges[i].degree);
+    }
+
+    size_t Degree(size_t i) const { return this->ranges[i].degree; }
+
+    // Binary search in the neighbours of 'source'.
+    bool HasEdge(uint32_t source, uint32_t target) const;
+
+    // Whether there's a path between 'a' and 'b', ignoring the direction of the edges.
+    // Time Complexity: O(α(V)), or O(V + E) the first time after a batch with deletions.
+    bool Connected(uint32_t a, uint32_t b);
+
+    size_t ComponentCount();
+
+    size_t VertexCount() const noexcept { return this->vertex_count; }
+    size_t EdgeCount()   const noexcept { return this->edge_count;   }
+
+private:
+    struct Range
+    {
+        size_t   offset;
+        uint32_t degree;
+        uint32_t room;
+    };
+
+    static uint32_t RoomFor(size_t degree);
+
+    // The size of the neighbour array right after 'Compact'.
+    size_t CompactSize() const { return this->edge_count + this->edge_count / 2 + DYNAMIC_GRAPH_MIN_ROOM * this->vertex_count; }
+
+    // Moves the lists back to back in vertex order, each with the room 'RoomFor' its degree.
+    void Compact(ThreadPool& pool);
+
+    void RebuildComponents();
+
+    std::vector<uint32_t> neighbours;
+    std::vector<Range>    ranges;
+    size_t vertex_count;
+    size_t edge_count;
+
+    using UnionFind = CompactUnionFind<uint32_t>;
+
+    unique_ptr<UnionFind> components;
+    size_t component_count;
+    bool   components_stale;   // A deletion may have split a component.
+};
@@ -0,0 +1,626 @@
+#include "graphs.h"
+#include "compressed_graph.h"
+#include "parallel_bfs.h"
+
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+// Graph500-style benchmark of the traversals over generated graphs. Every traversal runs from the same
+// random roots, its result is validated, and the traversed edges per second (TEPS) are summarized
+// over the roots. Prints one CSV row or JSON object per graph and traversal.
+// https://graph500.org/?page_id=12
+//
+//     GraphBench [--graph kronecker|rmat|grid|erdos-renyi|all] [--scale N] [--edge-factor N]
+//                [--roots N] [--format csv|json] [--output path] [--seed N] [--only name]
+
+
+// ---- Generators ----
+// All graphs are undirected, i.e. every edge is added in both directions, and have 2^scale vertices
+// (a grid rounds its side down). Edges are generated in fixed-size chunks, each with its own random
+// generator seeded from the chunk index, so a seed gives the same graph on any number of threads.
+enum class GraphKind { KRONECKER, RMAT, GRID, ERDOS_RENYI };
+
+static const char* GRAPH_NAMES[] = { "kronecker", "rmat", "grid", "erdos-renyi" };
+
+constexpr size_t GENERATOR_CHUNK_SIZE = 1 << 16;   // Edges per chunk.
+
+struct QuadrantProbabilities
+{
+    double a, b, c;   // d = 1 - a - b - c
+};
+
+// The Graph500 Kronecker initiator, and the original R-MAT parameters (Chakrabarti, Zhan and Faloutsos).
+constexpr QuadrantProbabilities KRONECKER_PROBABILITIES = { 0.57, 0.19, 0.19 };
+constexpr QuadrantProbabilities RMAT_PROBABILITIES      = { 0.45, 0.15, 0.15 };
+
+static std::mt19937_64 ChunkRandom(uint64_t seed, size_t chunk)
+{
+    return std::mt19937_64(seed * 0x9E3779B97F4A7C15ull + chunk);
+}
+
+// Each edge picks one quadrant of the adjacency matrix per bit of the vertex IDs, which gives the
+// skewed degrees and small diameter of social and web graphs. The IDs are then shuffled, so the hubs
+// aren't all at low IDs. Self-loops are dropped and duplicates kept, like Graph500 does.
+static std::vector<CsrEdge> RecursiveMatrixEdges(size_t scale, size_t edge_factor, QuadrantProbabilities p, uint64_t seed)
+{
+    const size_t vertex_count = size_t(1) << scale;
+    const size_t edge_count   = edge_factor * vertex_count;
+    const size_t chunk_count  = (edge_count + GENERATOR_CHUNK_SIZE - 1) / GENERATOR_CHUNK_SIZE;
+
+    std::vector<uint32_t> labels(vertex_count);
+    std::iota(labels.begin(), labels.end(), uint32_t(0));
+    std::mt19937_64 shuffle_random(seed);
+    std::shuffle(labels.begin(), labels.end(), shuffle_random);
+
+    std::vector<CsrEdge> edges(2 * edge_count);
+    std::vector<size_t>  chunk_sizes(chunk_count);
+
+    ParallelFor(ThreadPool::Global(), 0, chunk_count, 1, [&](size_t begin, size_t end)
+    {
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+        for (size_t chunk = begin; chunk < end; ++chunk)
+        {
+            auto random = ChunkRandom(seed, chunk);
+
+            CsrEdge* output = edges.data() + 2 * chunk * GENERATOR_CHUNK_SIZE;
+            size_t   count  = 0;
+
+            for (size_t i = chunk * GENERATOR_CHUNK_SIZE; i < std::min(edge_count, (chunk + 1) * GENERATOR_CHUNK_SIZE); ++i)
+            {
+                uint32_t source = 0;
+                uint32_t target = 0;
+                for (size_t bit = 0; bit < scale; ++bit)
+                {
+                    double r = uniform(random);
+                    source = (source << 1) | uint32_t(r >= p.a + p.b);
+                    target = (target << 1) | uint32_t((r >= p.a && r < p.a + p.b) || r >= p.a + p.b + p.c);
+                }
+
+                if (source == target)
+                    continue;
+
+                output[count++] = { labels[source], labels[target] };
+                output[count++] = { labels[target], labels[source] };
+            }
+            chunk_sizes[chunk] = count;
+        }
+    });
+
+    // Close the gaps left by the dropped self-loops.
+    size_t count = 0;
+    for (size_t chunk = 0; chunk < chunk_count; ++chunk)
+    {
+        const CsrEdge* chunk_edges = edges.data() + 2 * chunk * GENERATOR_CHUNK_SIZE;
+        std::copy(chunk_edges, chunk_edges + chunk_sizes[chunk], edges.begin() + count);
+        count += chunk_sizes[chunk];
+    }
+    edges.resize(count);
+
+    return edges;
+}
+
+// G(n, m): every edge joins two uniformly random distinct vertices.
+static std::vector<CsrEdge> ErdosRenyiEdges(size_t scale, size_t edge_factor, uint64_t seed)
+{
+    const size_t vertex_count = size_t(1) << scale;
+    const size_t edge_count   = edge_factor * vertex_count;
+    const size_t chunk_count  = (edge_count + GENERATOR_CHUNK_SIZE - 1) / GENERATOR_CHUNK_SIZE;
+
+    std::vector<CsrEdge> edges(2 * edge_count);
+
+    ParallelFor(ThreadPool::Global(), 0, chunk_count, 1, [&](size_t begin, size_t end)
+    {
+        for (size_t chunk = begin; chunk < end; ++chunk)
+        {
+            auto random = ChunkRandom(seed, chunk);
+            std::uniform_int_distribution<uint32_t> vertex(0, uint32_t(vertex_count - 1));
+
+            for (size_t i = chunk * GENERATOR_CHUNK_SIZE; i < std::min(edge_count, (chunk + 1) * GENERATOR_CHUNK_SIZE); ++i)
+            {
+                uint32_t source = vertex(random);
+                uint32_t target = vertex(random);
+                while (target == source && vertex_count > 1)
+                    target = vertex(random);
+
+                edges[2 * i]     = { source, target };
+                edges[2 * i + 1] = { target, source };
+            }
+        }
+    });
+
+    return edges;
+}
+
+// A square 2D mesh with 4 neighbours per vertex and IDs in row order, like road networks and meshes:
+// a large diameter and no hubs. The edge factor doesn't apply.
+static std::vector<CsrEdge> GridEdges(size_t side)
+{
+    std::vector<CsrEdge> edges;
+    edges.reserve(4 * side * side);
+
+    for (uint32_t y = 0; y < side; ++y)
+        for (uint32_t x = 0; x < side; ++x)
+        {
+            uint32_t v = uint32_t(y * side + x);
+            if (x + 1 < side)
+            {
+                edges.push_back({ v, v + 1 });
+                edges.push_back({ v + 1, v });
+            }
+            if (y + 1 < side)
+            {
+                edges.push_back({ v, uint32_t(v + side) });
+                edges.push_back({ uint32_t(v + side), v });
+            }
+        }
+
+    return edges;
+}
+
+static CsrGraph Generate(GraphKind kind, size_t scale, size_t edge_factor, uint64_t seed)
+{
+    switch (kind)
+    {
+        case GraphKind::KRONECKER:
+        {
+            auto edges = RecursiveMatrixEdges(scale, edge_factor, KRONECKER_PROBABILITIES, seed);
+            return CsrGraph(size_t(1) << scale, edges.data(), edges.size());
+        }
+        case GraphKind::RMAT:
+        {
+            auto edges = RecursiveMatrixEdges(scale, edge_factor, RMAT_PROBABILITIES, seed);
+            return CsrGraph(size_t(1) << scale, edges.data(), edges.size());
+        }
+        case GraphKind::GRID:
+        {
+            const size_t side = size_t(1) << (scale / 2);
+            auto edges = GridEdges(side);
+            return CsrGraph(side * side, edges.data(), edges.size());
+        }
+        case GraphKind::ERDOS_RENYI:
+        {
+            auto edges = ErdosRenyiEdges(scale, edge_factor, seed);
+            return CsrGraph(size_t(1) << scale, edges.data(), edges.size());
+        }
+    }
+
+    throw std::runtime_error("Unknown graph kind.");
+}
+
+
+// ---- Validation ----
+// The reference for every root is a parent tree, checked like Graph500 does: the root is its own
+// parent, the tree has no cycles, every tree edge is a graph edge one level down, and every graph
+// edge from a reached vertex leads to a reached vertex at most one level away.
+constexpr uint32_t NO_LEVEL = UINT32_MAX;
+
+static bool ValidateParents(const CsrGraph& graph, uint32_t root, const uint32_t* parents, uint32_t* levels)
+{
+    const size_t vertex_count = graph.VertexCount();
+
+    if (parents[root] != root)
+        return false;
+
+    std::fill(levels, levels + vertex_count, NO_LEVEL);
+    levels[root] = 0;
+
+    // The levels are found by walking up to a vertex with a known level. A walk longer than the
+    // number of vertices means the parents have a cycle.
+    std::vector<uint32_t> walk;
+    for (uint32_t v = 0; v < vertex_count; ++v)
+    {
+        if (parents[v] == BFS_NO_PARENT || levels[v] != NO_LEVEL)
+            continue;
+
+        walk.clear();
+        uint32_t u = v;
+        while (levels[u] == NO_LEVEL)
+        {
+            if (walk.size() > vertex_count || parents[u] == BFS_NO_PARENT || parents[u] >= vertex_count)
+                return false;
+            walk.push_back(u);
+            u = parents[u];
+        }
+
+        for (size_t i = walk.size(); i-- > 0; )
+            levels[walk[i]] = levels[parents[walk[i]]] + 1;
+    }
+
+    std::vector<bool> has_tree_edge(vertex_count);
+    has_tree_edge[root] = true;
+
+    for (uint32_t u = 0; u < vertex_count; ++u)
+        for (uint32_t v : graph.Edge(u))
+        {
+            if ((levels[u] == NO_LEVEL) != (levels[v] == NO_LEVEL))
+                return false;
+            if (levels[u] == NO_LEVEL)
+                continue;
+            if (levels[u] > levels[v] + 1 || levels[v] > levels[u] + 1)
+                return false;
+            if (parents[v] == u && levels[v] == levels[u] + 1)
+                has_tree_edge[v] = true;
+        }
+
+    for (uint32_t v = 0; v < vertex_count; ++v)
+        if (levels[v] != NO_LEVEL && !has_tree_edge[v])
+            return false;
+
+    return true;
+}
+
+// The traversals in graphs.h return a path, which has to start at the root, end at the target and
+// follow graph edges without repeating a vertex. A breadth first path must also be a shortest one.
+static bool ValidatePath(const CsrGraph& graph, const DynamicArray<uint32_t>& path, uint32_t root, uint32_t target,
+                         const uint32_t* levels, bool shortest)
+{
+    if (path.Count() == 0 || path[0] != root || path[path.Count() - 1] != target)
+        return false;
+    if (shortest && path.Count() != levels[target] + 1)
+        return false;
+
+    std::vector<bool> seen(graph.VertexCount());
+    for (size_t i = 0; i < path.Count(); ++i)
+    {
+        if (seen[path[i]])
+            return false;
+        seen[path[i]] = true;
+
+        if (i > 0)
+        {
+            const auto& neighbours = graph.Edge(path[i - 1]);
+            if (std::find(neighbours.begin(), neighbours.end(), path[i]) == neighbours.end())
+                return false;
+        }
+    }
+
+    return true;
+}
+
+
+// ---- Driver ----
+struct Options
+{
+    std::string graph  = "all";
+    std::string format = "csv";
+    std::string output;
+    std::string only;
+    size_t scale       = 16;
+    size_t edge_factor = 16;
+    size_t roots       = 16;
+    uint64_t seed      = 42;
+};
+
+struct Result
+{
+    const char* graph;
+    const char* algorithm;
+    size_t      scale;
+    size_t      vertices;
+    size_t      edges;          // Undirected edges, i.e. half the CSR edges.
+    size_t      roots;
+    double      median_ms;
+    double      teps[5];        // Minimum, first quartile, median, third quartile and maximum.
+    double      harmonic_mean_teps;
+    bool        valid;
+};
+
+static const char* PERCENTILE_NAMES[] = { "min", "p25", "median", "p75", "max" };
+
+class ResultWriter
+{
+public:
+    ResultWriter(FILE* file, bool json) : file(file), json(json), first(true)
+    {
+        if (this->json)
+            fprintf(this->file, "[\n");
+        else
+            fprintf(this->file, "graph,algorithm,scale,vertices,edges,roots,median_ms,teps_min,teps_p25,teps_median,teps_p75,teps_max,teps_harmonic_mean,valid\n");
+    }
+    ~ResultWriter()
+    {
+        if (this->json)
+            fprintf(this->file, "\n]\n");
+    }
+
+    void Write(const Result& result)
+    {
+        if (this->json)
+        {
+            fprintf(this->file,
+                    "%s  {\"graph\": \"%s\", \"algorithm\": \"%s\", \"scale\": %zu, \"vertices\": %zu, \"edges\": %zu, "
+                    "\"roots\": %zu, \"median_ms\": %.3f, ",
+                    this->first ? "" : ",\n", result.graph, result.algorithm, result.scale, result.vertices,
+                    result.edges, result.roots, result.median_ms);
+            for (size_t i = 0; i < ARRAY_SIZE(PERCENTILE_NAMES); ++i)
+                fprintf(this->file, "\"teps_%s\": %.6e, ", PERCENTILE_NAMES[i], result.teps[i]);
+            fprintf(this->file, "\"teps_harmonic_mean\": %.6e, \"valid\": %s}", result.harmonic_mean_teps, result.valid ? "true" : "false");
+        }
+        else
+        {
+            fprintf(this->file, "%s,%s,%zu,%zu,%zu,%zu,%.3f,", result.graph, result.algorithm, result.scale,
+                    result.vertices, result.edges, result.roots, result.median_ms);
+            for (double teps : result.teps)
+                fprintf(this->file, "%.6e,", teps);
+            fprintf(this->file, "%.6e,%s\n", result.harmonic_mean_teps, result.valid ? "true" : "false");
+        }
+
+        this->first = false;
+        fflush(this->file);
+    }
+
+private:
+    FILE* file;
+    bool  json;
+    bool  first;
+};
+
+// The generated graph, and the same graph with compressed neighbour lists.
+struct BenchGraph
+{
+    explicit BenchGraph(const CsrGraph& graph) : csr(graph), compressed(graph) {}
+
+    CsrGraph           csr;
+    CompressedCsrGraph compressed;
+};
+
+// Runs one traversal from 'root' and returns whether its result is valid. 'levels' are the BFS levels
+// from the reference tree, and 'target' is a random vertex it reached, for the searches that need one.
+using Traversal = bool (*)(const BenchGraph& graph, uint32_t root, uint32_t target, const uint32_t* levels,
+                           uint32_t* parents, double& milliseconds);
+
+template <class F>
+static double TimeMilliseconds(F&& function)
+{
+    auto start = std::chrono::steady_clock::now();
+    function();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// The path searches are timed without a target (NO_VERTEX is never found), so they traverse the
+// whole component like the other traversals, and then run once more to the target to check the path.
+// The paths are checked against the uncompressed graph, which has the same edges.
+template <class G>
+static bool RunBreadthFirstSearch(const G& graph, const CsrGraph& reference, uint32_t root, uint32_t target, const uint32_t* levels, double& milliseconds)
+{
+    milliseconds = TimeMilliseconds([&] { BreadthFirstSearch<Queue>(graph, root, NO_VERTEX); });
+    return ValidatePath(reference, BreadthFirstSearch<Queue>(graph, root, target), root, target, levels, true);
+}
+
+template <class G>
+static bool RunDepthFirstSearch(const G& graph, const CsrGraph& reference, uint32_t root, uint32_t target, const uint32_t* levels, double& milliseconds)
+{
+    milliseconds = TimeMilliseconds([&] { DepthFirstSearch(graph, root, NO_VERTEX); });
+    return ValidatePath(reference, DepthFirstSearch(graph, root, target), root, target, levels, false);
+}
+
+static bool RunBreadthFirstSearch(const BenchGraph& graph, uint32_t root, uint32_t target, const uint32_t* levels, uint32_t*, double& milliseconds)
+{
+    return RunBreadthFirstSearch(graph.csr, graph.csr, root, target, levels, milliseconds);
+}
+
+static bool RunDepthFirstSearch(const BenchGraph& graph, uint32_t root, uint32_t target, const uint32_t* levels, uint32_t*, double& milliseconds)
+{
+    return RunDepthFirstSearch(graph.csr, graph.csr, root, target, levels, milliseconds);
+}
+
+static bool RunCompressedBreadthFirstSearch(const BenchGraph& graph, uint32_t root, uint32_t target, const uint32_t* levels, uint32_t*, double& milliseconds)
+{
+    return RunBreadthFirstSearch(graph.compressed, graph.csr, root, target, levels, milliseconds);
+}
+
+static bool RunCompressedDepthFirstSearch(const BenchGraph& graph, uint32_t root, uint32_t target, const uint32_t* levels, uint32_t*, double& milliseconds)
+{
+    return RunDepthFirstSearch(graph.compressed, graph.csr, root, target, levels, milliseconds);
+}
+
+static bool RunParallelBreadthFirstSearch(const BenchGraph& graph, uint32_t root, uint32_t, const uint32_t*, uint32_t* parents, double& milliseconds)
+{
+    milliseconds = TimeMilliseconds([&] { ParallelBreadthFirstSearch(graph.csr, root, parents); });
+
+    auto levels = make_unique<uint32_t[]>(graph.csr.VertexCount());
+    return ValidateParents(graph.csr, root, parents, levels.get());
+}
+
+struct Algorithm
+{
+    const char* name;
+    Traversal   run;
+};
+
+static const Algorithm ALGORITHMS[] = {
+    { "ParallelBreadthFirstSearch",   RunParallelBreadthFirstSearch },
+    { "BreadthFirstSearch",           RunBreadthFirstSearch },
+    { "DepthFirstSearch",             RunDepthFirstSearch },
+    { "CompressedBreadthFirstSearch", RunCompressedBreadthFirstSearch },
+    { "CompressedDepthFirstSearch",   RunCompressedDepthFirstSearch },
+};
+
+static double Percentile(const std::vector<double>& sorted, double fraction)
+{
+    return sorted[size_t(fraction * double(sorted.size() - 1) + 0.5)];
+}
+
+static void Run(GraphKind kind, const Options& options, ResultWriter& writer)
+{
+    const BenchGraph bench_graph(Generate(kind, options.scale, options.edge_factor, options.seed));
+    const CsrGraph&  graph        = bench_graph.csr;
+    const size_t     vertex_count = graph.VertexCount();
+
+    // Graph500 only picks roots that have edges.
+    std::mt19937_64 random(options.seed);
+    std::uniform_int_distribution<uint32_t> vertex(0, uint32_t(vertex_count - 1));
+
+    std::vector<uint32_t> roots;
+    for (size_t attempt = 0; roots.size() < options.roots && attempt < 64 * options.roots; ++attempt)
+    {
+        uint32_t root = vertex(random);
+        if (graph.Degree(root) > 0)
+            roots.push_back(root);
+    }
+    if (roots.empty())
+        throw std::runtime_error("The graph has no edges.");
+
+    // The reference tree of every root gives the levels to check paths against, a target, and the
+    // number of edges in the component, which is what TEPS counts.
+    auto parents = make_unique<uint32_t[]>(vertex_count);
+    std::vector<unique_ptr<uint32_t[]>> levels;
+    std::vector<uint32_t> targets;
+    std::vector<size_t>   traversed_edges;
+    bool references_valid = true;
+
+    for (uint32_t root : roots)
+    {
+        ParallelBreadthFirstSearch(graph, root, parents.get());
+        levels.push_back(make_unique<uint32_t[]>(vertex_count));
+        references_valid &= ValidateParents(graph, root, parents.get(), levels.back().get());
+
+        std::vector<uint32_t> reached;
+        size_t degrees = 0;
+        for (uint32_t v = 0; v < vertex_count; ++v)
+            if (levels.back()[v] != NO_LEVEL)
+            {
+                reached.push_back(v);
+                degrees += graph.Degree(v);
+            }
+
+        targets.push_back(reached[random() % reached.size()]);
+        traversed_edges.push_back(degrees / 2);
+    }
+
+    for (const Algorithm& algorithm : ALGORITHMS)
+    {
+        if (!options.only.empty() && options.only != algorithm.name)
+            continue;
+
+        std::vector<double> times;
+        std::vector<double> teps;
+        bool valid = references_valid;
+
+        for (size_t i = 0; i < roots.size(); ++i)
+        {
+            double milliseconds = 0;
+            valid &= algorithm.run(bench_graph, roots[i], targets[i], levels[i].get(), parents.get(), milliseconds);
+
+            times.push_back(milliseconds);
+            teps.push_back(double(traversed_edges[i]) / (std::max(milliseconds, 1e-6) / 1000.0));
+        }
+
+        std::sort(times.begin(), times.end());
+        std::sort(teps.begin(), teps.end());
+
+        double inverse_sum = 0;
+        for (double value : teps)
+            inverse_sum += 1.0 / value;
+
+        Result result = {};
+        result.graph     = GRAPH_NAMES[size_t(kind)];
+        result.algorithm = algorithm.name;
+        result.scale     = options.scale;
+        result.vertices  = vertex_count;
+        result.edges     = graph.EdgeCount() / 2;
+        result.roots     = roots.size();
+        result.median_ms = Percentile(times, 0.5);
+        result.teps[0]   = Percentile(teps, 0.0);
+        result.teps[1]   = Percentile(teps, 0.25);
+        result.teps[2]   = Percentile(teps, 0.5);
+        result.teps[3]   = Percentile(teps, 0.75);
+        result.teps[4]   = Percentile(teps, 1.0);
+        result.harmonic_mean_teps = double(teps.size()) / inverse_sum;
+        result.valid     = valid;
+
+        writer.Write(result);
+    }
+}
+
+static void PrintUsage()
+{
+    fprintf(stderr,
+            "Usage: GraphBench [options]\n"
+            "  --graph kronecker|rmat|grid|erdos-renyi|all  Graphs to generate (default all).\n"
+            "  --scale N                                    2^N vertices, up to 31 (default 16).\n"
+            "  --edge-factor N                              Edges per vertex, except for grids (default 16).\n"
+            "  --roots N                                    Traversals per algorithm (default 16).\n"
+            "  --format csv|json                            Output format (default csv).\n"
+            "  --output path                                Write to a file instead of stdout.\n"
+            "  --only name                                  Run a single traversal, e.g. DepthFirstSearch.\n"
+            "  --seed N                                     Seed for the generators and roots (default 42).\n");
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+
+    // 'std::stoull' throws 'std::invalid_argument' or 'std::out_of_range' for a bad number.
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string argument = argv[i];
+            const bool has_value = i + 1 < argc;
+
+            if      (argument == "--graph"       && has_value) options.graph  = argv[++i];
+            else if (argument == "--format"      && has_value) options.format = argv[++i];
+            else if (argument == "--output"      && has_value) options.output = argv[++i];
+            else if (argument == "--only"        && has_value) options.only   = argv[++i];
+            else if (argument == "--scale"       && has_value) options.scale       = std::stoull(argv[++i]);
+            else if (argument == "--edge-factor" && has_value) options.edge_factor = std::stoull(argv[++i]);
+            else if (argument == "--roots"       && has_value) options.roots       = std::stoull(argv[++i]);
+            else if (argument == "--seed"        && has_value) options.seed        = std::stoull(argv[++i]);
+            else
+            {
+                PrintUsage();
+                return argument == "--help" ? 0 : 1;
+            }
+        }
+    }
+    catch (const std::logic_error&)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    std::vector<GraphKind> kinds;
+    for (size_t k = 0; k < ARRAY_SIZE(GRAPH_NAMES); ++k)
+        if (options.graph == "all" || options.graph == GRAPH_NAMES[k])
+            kinds.push_back(GraphKind(k));
+
+    if (kinds.empty() || options.scale == 0 || options.scale > 31 || options.edge_factor == 0 || options.roots == 0 ||
+        (options.format != "csv" && options.format != "json"))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    FILE* file = options.output.empty() ? stdout : fopen(options.output.c_str(), "w");
+    if (file == nullptr)
+    {
+        fprintf(stderr, "Couldn't open '%s'.\n", options.output.c_str());
+        return 1;
+    }
+
+    int status = 0;
+    try
+    {
+        ResultWriter writer(file, options.format == "json");
+        for (GraphKind kind : kinds)
+            Run(kind, options, writer);
+    }
+    catch (const std::runtime_error& error)
+    {
+        // E.g. a grid at scale 1 is a single vertex, with no edges to traverse.
+        fprintf(stderr, "%s\n", error.what());
+        status = 1;
+    }
+
+    if (file != stdout)
+        fclose(file);
+    return status;
+}
@@ -0,0 +1,410 @@
+#include "graph_io.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define GRAPH_IO_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define GRAPH_IO_MMAP 0
+#endif
+
+#include "sorting.h"
+
+
+static_assert(sizeof(CsrSnapshotHeader) == 64, "The snapshot header is part of the file format.");
+static_assert(sizeof(size_t) == sizeof(uint64_t), "Snapshots store the offsets as they are in memory.");
+
+constexpr size_t TEXT_CHUNK_SIZE = 1 << 22;   // Bytes of text per parsing task.
+
+
+// A read-only view of a whole file. It's mapped where the OS supports it, and read into memory
+// otherwise.
+class MappedFile
+{
+public:
+    explicit MappedFile(const char* path) : data(nullptr), size(0), mapped(false)
+    {
+#if GRAPH_IO_MMAP
+        int file = open(path, O_RDONLY);
+        if (file < 0)
+            throw std::runtime_error(std::string("Couldn't open ") + path);
+
+        struct stat status;
+        if (fstat(file, &status) != 0)
+        {
+            close(file);
+            throw std::runtime_error(std::string("Couldn't read the size of ") + path);
+        }
+
+        this->size = size_t(status.st_size);
+        if (this->size > 0)
+        {
+            void* address = mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, file, 0);
+            close(file);
+            if (address == MAP_FAILED)
+                throw std::runtime_error(std::string("Couldn't map ") + path);
+
+            this->data   = static_cast<const char*>(address);
+            this->mapped = true;
+        }
+        else
+        {
+            close(file);
+        }
+#else
+        FILE* file = fopen(path, "rb");
+        if (file == nullptr)
+            throw std::runtime_error(std::string("Couldn't open ") + path);
+
+        fseek(file, 0, SEEK_END);
+        this->size = size_t(ftell(file));
+        fseek(file, 0, SEEK_SET);
+
+        this->buffer = unique_ptr<char[]>(new char[this->size]);
+        size_t read = fread(this->buffer.get(), 1, this->size, file);
+        fclose(file);
+        if (read != this->size)
+            throw std::runtime_error(std::string("Couldn't read ") + path);
+
+        this->data = this->buffer.get();
+#endif
+    }
+
+    ~MappedFile()
+    {
+#if GRAPH_IO_MMAP
+        if (this->mapped)
+            munmap(const_cast<char*>(this->data), this->size);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator= (const MappedFile&) = delete;
+
+    const char* Data() const noexcept { return this->data; }
+    size_t      Size() const noexcept { return this->size; }
+
+private:
+    const char* data;
+    size_t size;
+    bool mapped;
+    unique_ptr<char[]> buffer;
+};
+
+
+struct TextEdge
+{
+    uint64_t source;
+    uint64_t target;
+};
+
+static bool IsBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+static const char* SkipBlanks(const char* at, const char* end)
+{
+    while (at < end && IsBlank(*at))
+        ++at;
+    return at;
+}
+
+static const char* LineEnd(const char* at, const char* end)
+{
+    const char* newline = static_cast<const char*>(memchr(at, '\n', size_t(end - at)));
+    return (newline != nullptr) ? newline : end;
+}
+
+// Parses an unsigned decimal integer at 'at' and moves past it. Returns false if there's none, or it
+// doesn't fit in 64 bits.
+static bool ParseUnsigned(const char*& at, const char* end, uint64_t& value)
+{
+    at = SkipBlanks(at, end);
+
+    const char* first = at;
+    value = 0;
+    while (at < end && unsigned(*at - '0') < 10)
+    {
+        uint64_t digit = uint64_t(*at - '0');
+        if (value > (UINT64_MAX - digit) / 10)
+            return false;
+        value = 10 * value + digit;
+        ++at;
+    }
+
+    return at != first;
+}
+
+static size_t LineNumber(const char* begin, const char* at)
+{
+    return size_t(std::count(begin, at, '\n')) + 1;
+}
+
+// Parses the lines of [begin, end) in parallel chunks that start and end at line breaks. Lines that
+// are empty or start with 'comment' are skipped, and the rest must start with two unsigned integers.
+static std::vector<TextEdge> ParseEdges(ThreadPool& pool, const char* path, const char* file_begin, const char* begin, const char* end, char comment)
+{
+    size_t chunk_count = std::max<size_t>(1, size_t(end - begin) / TEXT_CHUNK_SIZE);
+
+    std::vector<const char*> bounds(chunk_count + 1);
+    bounds[0]           = begin;
+    bounds[chunk_count] = end;
+    for (size_t i = 1; i < chunk_count; ++i)
+    {
+        const char* at = begin + size_t(end - begin) * i / chunk_count;
+        at = LineEnd(std::max(at, bounds[i - 1]), end);
+        bounds[i] = (at < end) ? at + 1 : end;
+    }
+
+    std::vector<std::vector<TextEdge>> chunks(chunk_count);
+    std::atomic<const char*> error(nullptr);   // The first bad line found, though not necessarily the first in the file.
+
+    ParallelFor(pool, 0, chunk_count, 1, [&](size_t first_chunk, size_t last_chunk)
+    {
+        for (size_t c = first_chunk; c < last_chunk; ++c)
+        {
+            std::vector<TextEdge>& edges = chunks[c];
+
+            for (const char* line = bounds[c]; line < bounds[c + 1]; )
+            {
+                const char* line_end = LineEnd(line, bounds[c + 1]);
+                const char* at       = SkipBlanks(line, line_end);
+
+                if (at < line_end && *at != comment)
+                {
+                    TextEdge edge;
+                    if (!ParseUnsigned(at, line_end, edge.source) || !ParseUnsigned(at, line_end, edge.target))
+                    {
+                        const char* expected = nullptr;
+                        error.compare_exchange_strong(expected, line);
+                        return;
+                    }
+                    edges.push_back(edge);
+                }
+
+                line = line_end + 1;
+            }
+        }
+    });
+
+    if (error.load() != nullptr)
+        throw std::runtime_error(std::string("Expected two vertex IDs on line ") + std::to_string(LineNumber(file_begin, error.load())) + " of " + path);
+
+    size_t total = 0;
+    for (const auto& chunk : chunks)
+        total += chunk.size();
+
+    std::vector<TextEdge> edges;
+    edges.reserve(total);
+    for (auto& chunk : chunks)
+    {
+        edges.insert(edges.end(), chunk.begin(), chunk.end());
+        std::vector<TextEdge>().swap(chunk);
+    }
+
+    return edges;
+}
+
+static CsrGraph BuildGraph(ThreadPool& pool, size_t vertex_count, const std::vector<TextEdge>& edges, bool mirrored,
+                           const uint64_t* ids = nullptr)
+{
+    const size_t edge_count = edges.size();
+
+    std::vector<CsrEdge> csr_edges(mirrored ? 2 * edge_count : edge_count);
+    std::atomic<size_t>  mirror_count(0);
+
+    ParallelFor(pool, 0, edge_count, PARALLEL_SORT_GRAIN_SIZE, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            uint64_t source = edges[i].source;
+            uint64_t target = edges[i].target;
+
+            // Binary search the sorted, unique IDs for the new ones.
+            if (ids != nullptr)
+            {
+                source = uint64_t(std::lower_bound(ids, ids + vertex_count, source) - ids);
+                target = uint64_t(std::lower_bound(ids, ids + vertex_count, target) - ids);
+            }
+
+            csr_edges[i] = { uint32_t(source), uint32_t(target) };
+        }
+    });
+
+    // The mirrored edges go after the originals, except for self-loops, which are already there.
+    if (mirrored)
+    {
+        size_t count = edge_count;
+        for (size_t i = 0; i < edge_count; ++i)
+            if (csr_edges[i].source != csr_edges[i].target)
+                csr_edges[count++] = { csr_edges[i].target, csr_edges[i].source };
+        csr_edges.resize(count);
+    }
+
+    return CsrGraph(vertex_count, csr_edges.data(), csr_edges.size());
+}
+
+
+CsrGraph LoadSnapEdgeList(const char* path, bool undirected, std::vector<uint64_t>* original_ids, ThreadPool& pool)
+{
+    std::vector<TextEdge> edges;
+    {
+        MappedFile file(path);
+        edges = ParseEdges(pool, path, file.Data(), file.Data(), file.Data() + file.Size(), '#');
+    }
+
+    std::vector<uint64_t> ids(2 * edges.size());
+    for (size_t i = 0; i < edges.size(); ++i)
+    {
+        ids[2 * i]     = edges[i].source;
+        ids[2 * i + 1] = edges[i].target;
+    }
+
+    RadixSort(ids.data(), ids.size());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+    if (ids.size() > size_t(UINT32_MAX))
+        throw std::runtime_error(std::string("Too many vertices for 32-bit IDs in ") + path);
+
+    CsrGraph graph = BuildGraph(pool, ids.size(), edges, undirected, ids.data());
+
+    if (original_ids != nullptr)
+        *original_ids = std::move(ids);
+
+    return graph;
+}
+
+CsrGraph LoadMatrixMarket(const char* path, ThreadPool& pool)
+{
+    std::vector<TextEdge> edges;
+    uint64_t rows, columns, nonzeros;
+    bool     mirrored;
+    {
+        MappedFile file(path);
+        const char* begin = file.Data();
+        const char* end   = begin + file.Size();
+
+        const char* line_end = LineEnd(begin, end);
+        std::string banner(begin, line_end);
+        for (char& c : banner)
+            c = char(tolower(c));
+
+        if (banner.rfind("%%matrixmarket matrix coordinate", 0) != 0)
+            throw std::runtime_error(std::string("Not a Matrix Market coordinate file: ") + path);
+
+        mirrored = banner.find("symmetric") != std::string::npos || banner.find("hermitian") != std::string::npos;
+
+        // Skip the comments up to the size line.
+        const char* at = (line_end < end) ? line_end + 1 : end;
+        while (at < end)
+        {
+            line_end = LineEnd(at, end);
+            if (*at != '%' && SkipBlanks(at, line_end) != line_end)
+                break;
+            at = (line_end < end) ? line_end + 1 : end;
+        }
+
+        line_end = LineEnd(at, end);
+        if (!ParseUnsigned(at, line_end, rows) || !ParseUnsigned(at, line_end, columns) || !ParseUnsigned(at, line_end, nonzeros))
+            throw std::runtime_error(std::string("Expected the matrix size on line ") + std::to_string(LineNumber(begin, at)) + " of " + path);
+
+        at = (line_end < end) ? line_end + 1 : end;
+        edges = ParseEdges(pool, path, begin, at, end, '%');
+    }
+
+    if (edges.size() != nonzeros)
+        throw std::runtime_error(std::string("Number of entries doesn't match the header in ") + path);
+
+    const uint64_t vertex_count = std::max(rows, columns);
+    if (vertex_count > uint64_t(UINT32_MAX))
+        throw std::runtime_error(std::string("Too many vertices for 32-bit IDs in ") + path);
+
+    for (TextEdge& edge : edges)
+    {
+        if (edge.source == 0 || edge.source > rows || edge.target == 0 || edge.target > columns)
+            throw std::runtime_error(std::string("Entry outside of the matrix in ") + path);
+
+        edge.source -= 1;
+        edge.target -= 1;
+    }
+
+    return BuildGraph(pool, size_t(vertex_count), edges, mirrored);
+}
+
+
+void SaveSnapshot(const CsrGraph& graph, const char* path)
+{
+    CsrSnapshotHeader header = {};
+    memcpy(header.magic, CSR_SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version             = CSR_SNAPSHOT_VERSION;
+    header.byte_order          = CSR_SNAPSHOT_BYTE_ORDER;
+    header.vertex_count        = graph.VertexCount();
+    header.edge_count          = graph.EdgeCount();
+    header.offsets_position    = sizeof(CsrSnapshotHeader);
+    header.neighbours_position = header.offsets_position + (graph.VertexCount() + 1) * sizeof(size_t);
+
+    FILE* file = fopen(path, "wb");
+    if (file == nullptr)
+        throw std::runtime_error(std::string("Couldn't open ") + path + " for writing.");
+
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   fwrite(graph.Offsets(), sizeof(size_t), graph.VertexCount() + 1, file) == graph.VertexCount() + 1 &&
+                   fwrite(graph.Neighbours(), sizeof(uint32_t), graph.EdgeCount(), file) == graph.EdgeCount();
+
+    if (fclose(file) != 0 || !written)
+        throw std::runtime_error(std::string("Couldn't write ") + path);
+}
+
+// Whether 'count' elements of 'element_size' bytes starting at 'position' lie within the file,
+// without any of the arithmetic being able to wrap around.
+static bool FitsInFile(uint64_t position, uint64_t count, uint64_t element_size, uint64_t file_size)
+{
+    return position <= file_size && count <= (file_size - position) / element_size;
+}
+
+CsrGraph LoadSnapshot(const char* path)
+{
+    auto file = std::make_shared<MappedFile>(path);
+
+    CsrSnapshotHeader header;
+    if (file->Size() < sizeof(header))
+        throw std::runtime_error(std::string("Not a graph snapshot: ") + path);
+    memcpy(&header, file->Data(), sizeof(header));
+
+    if (memcmp(header.magic, CSR_SNAPSHOT_MAGIC, sizeof(header.magic)) != 0)
+        throw std::runtime_error(std::string("Not a graph snapshot: ") + path);
+    if (header.version != CSR_SNAPSHOT_VERSION)
+        throw std::runtime_error(std::string("Unsupported graph snapshot version ") + std::to_string(header.version) + " in " + path);
+    if (header.byte_order != CSR_SNAPSHOT_BYTE_ORDER)
+        throw std::runtime_error(std::string("Graph snapshot was written with another byte order: ") + path);
+
+    if (header.vertex_count > uint64_t(UINT32_MAX) ||
+        !FitsInFile(header.offsets_position,    header.vertex_count + 1, sizeof(size_t),   file->Size()) ||
+        !FitsInFile(header.neighbours_position, header.edge_count,       sizeof(uint32_t), file->Size()) ||
+        header.offsets_position % alignof(size_t) != 0 || header.neighbours_position % alignof(uint32_t) != 0)
+        throw std::runtime_error(std::string("Graph snapshot is truncated or corrupt: ") + path);
+
+    const auto* offsets    = reinterpret_cast<const size_t*>(file->Data() + header.offsets_position);
+    const auto* neighbours = reinterpret_cast<const uint32_t*>(file->Data() + header.neighbours_position);
+
+    // The traversals trust the offsets and neighbours, so check them once up front.
+    if (offsets[0] != 0 || offsets[header.vertex_count] != header.edge_count)
+        throw std::runtime_error(std::string("Graph snapshot has corrupt offsets: ") + path);
+    for (uint64_t vertex = 0; vertex < header.vertex_count; ++vertex)
+        if (offsets[vertex + 1] < offsets[vertex])
+            throw std::runtime_error(std::string("Graph snapshot has corrupt offsets: ") + path);
+    for (uint64_t edge = 0; edge < header.edge_count; ++edge)
+        if (neighbours[edge] >= header.vertex_count)
+            throw std::runtime_error(std::string("Graph snapshot has a neighbour out of range: ") + path);
+
+    return CsrGraph(size_t(header.vertex_count), size_t(header.edge_count), offsets, neighbours, std::move(file));
+}
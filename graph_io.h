@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "graphs.h"
+#include "thread_pool.h"
+
+
+// Loading graphs from files. The text loaders map the file, split it into chunks at line breaks and
+// parse the chunks in parallel on the pool, then build a 'CsrGraph' from the edges.
+
+// SNAP edge lists (https://snap.stanford.edu/data/): a "source target" pair of unsigned integers per
+// line, separated by whitespace, with '#' starting a comment line. Anything after the pair is ignored.
+// The IDs can be sparse and up to 64 bits, so they're remapped to 0 to V - 1 in increasing order of
+// the original ID, which is written to original_ids[new ID] if it isn't null. With 'undirected' every
+// edge is added in both directions, as SNAP lists the edges of undirected graphs once.
+CsrGraph LoadSnapEdgeList(const char* path, bool undirected = false, std::vector<uint64_t>* original_ids = nullptr,
+                          ThreadPool& pool = ThreadPool::Global());
+
+// Matrix Market coordinate files (https://math.nist.gov/MatrixMarket/formats.html): the nonzero at
+// row i and column j is an edge from i - 1 to j - 1, and the values are ignored. Matrices stored as
+// symmetric (or skew-symmetric or Hermitian) only list one triangle, so the mirrored edges are added.
+CsrGraph LoadMatrixMarket(const char* path, ThreadPool& pool = ThreadPool::Global());
+
+
+// Binary snapshots that load without parsing or copying: the file is mapped into memory and the graph
+// uses the offsets and neighbours in it directly. Loading only makes one sequential pass to check that
+// the offsets are monotonic and the neighbours in range, so a corrupt file is rejected instead of read
+// out of bounds. The file is the header followed by the two arrays as they are in memory:
+//
+//     CsrSnapshotHeader     64 bytes
+//     offsets               8 * (V + 1) bytes, at 'offsets_position'
+//     neighbours            4 * E bytes, at 'neighbours_position'
+//
+// The version is bumped whenever the layout changes, and a snapshot is only loaded by the version and
+// byte order that wrote it.
+constexpr char     CSR_SNAPSHOT_MAGIC[8]    = { 'C', 'S', 'R', 'G', 'R', 'A', 'P', 'H' };
+constexpr uint32_t CSR_SNAPSHOT_VERSION     = 1;
+constexpr uint32_t CSR_SNAPSHOT_BYTE_ORDER  = 0x01020304;
+
+struct CsrSnapshotHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t vertex_count;
+    uint64_t edge_count;
+    uint64_t offsets_position;
+    uint64_t neighbours_position;
+    uint64_t reserved[2];
+};
+
+void     SaveSnapshot(const CsrGraph& graph, const char* path);
+CsrGraph LoadSnapshot(const char* path);
@@ -0,0 +1,215 @@
+#include "graph_ordering.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+
+// Vertices sorted by increasing degree, ties by ID.
+static unique_ptr<size_t[]> ByDegree(const CsrGraph& graph)
+{
+    const size_t vertex_count = graph.VertexCount();
+
+    auto degrees = unique_ptr<uint64_t[]>(new uint64_t[vertex_count]);
+    for (size_t i = 0; i < vertex_count; ++i)
+        degrees[i] = graph.Degree(i);
+
+    auto order = unique_ptr<size_t[]>(new size_t[vertex_count]);
+    ArgSort(degrees.get(), vertex_count, order.get());
+    return order;
+}
+
+static void DegreeOrder(const CsrGraph& graph, size_t* old_ids)
+{
+    const size_t vertex_count = graph.VertexCount();
+
+    auto keys = unique_ptr<uint64_t[]>(new uint64_t[vertex_count]);
+    for (size_t i = 0; i < vertex_count; ++i)
+        keys[i] = UINT64_MAX - graph.Degree(i);
+
+    ArgSort(keys.get(), vertex_count, old_ids);
+}
+
+static void BreadthFirstOrder(const CsrGraph& graph, size_t* old_ids)
+{
+    const size_t vertex_count = graph.VertexCount();
+    auto visited = make_unique<bool[]>(vertex_count);
+
+    // The order is its own queue: the vertices in [head, tail) are waiting to be expanded.
+    size_t tail = 0;
+    for (size_t root = 0; root < vertex_count; ++root)
+    {
+        if (visited[root])
+            continue;
+
+        visited[root]    = true;
+        old_ids[tail++]  = root;
+
+        for (size_t head = tail - 1; head < tail; ++head)
+            for (uint32_t neighbour : graph.Edge(old_ids[head]))
+                if (!visited[neighbour])
+                {
+                    visited[neighbour] = true;
+                    old_ids[tail++]    = neighbour;
+                }
+    }
+}
+
+// BFS from 'start' over the vertices that aren't 'visited' yet, to find a vertex as far from it as
+// possible, preferring a low degree. Returns that vertex and the distance to it in 'eccentricity'.
+static size_t FarthestVertex(const CsrGraph& graph, size_t start, const bool* visited, uint32_t* stamps, uint32_t stamp,
+                             size_t* queue, size_t& eccentricity)
+{
+    size_t head = 0, tail = 0;
+    queue[tail++]  = start;
+    stamps[start]  = stamp;
+    eccentricity   = 0;
+
+    size_t farthest = start;
+    while (head < tail)
+    {
+        // One level at a time, keeping the lowest degree vertex of the last one.
+        size_t level_end = tail;
+        farthest = queue[head];
+
+        for (; head < level_end; ++head)
+        {
+            size_t vertex = queue[head];
+            if (graph.Degree(vertex) < graph.Degree(farthest))
+                farthest = vertex;
+
+            for (uint32_t neighbour : graph.Edge(vertex))
+                if (!visited[neighbour] && stamps[neighbour] != stamp)
+                {
+                    stamps[neighbour] = stamp;
+                    queue[tail++]     = neighbour;
+                }
+        }
+
+        if (head < tail)
+            ++eccentricity;
+    }
+
+    return farthest;
+}
+
+static void ReverseCuthillMcKeeOrder(const CsrGraph& graph, size_t* old_ids)
+{
+    constexpr size_t PERIPHERAL_SEARCHES = 4;
+
+    const size_t vertex_count = graph.VertexCount();
+
+    auto visited    = make_unique<bool[]>(vertex_count);
+    auto stamps     = make_unique<uint32_t[]>(vertex_count);
+    auto queue      = unique_ptr<size_t[]>(new size_t[vertex_count]);
+    auto by_degree  = ByDegree(graph);
+    uint32_t stamp  = 0;
+
+    std::vector<uint64_t> neighbours;
+
+    size_t tail = 0;
+    for (size_t i = 0; i < vertex_count; ++i)
+    {
+        size_t root = by_degree[i];
+        if (visited[root])
+            continue;
+
+        // A pseudo-peripheral vertex (George and Liu): hop to the farthest vertex while that makes the
+        // eccentricity grow. Starting at an end of the component gives narrow BFS levels.
+        size_t eccentricity = 0;
+        size_t candidate_eccentricity;
+        for (size_t search = 0; search < PERIPHERAL_SEARCHES; ++search)
+        {
+            size_t candidate = FarthestVertex(graph, root, visited.get(), stamps.get(), ++stamp, queue.get(), candidate_eccentricity);
+            if (candidate_eccentricity <= eccentricity && search > 0)
+                break;
+
+            eccentricity = candidate_eccentricity;
+            root = candidate;
+        }
+
+        visited[root]   = true;
+        old_ids[tail++] = root;
+
+        for (size_t head = tail - 1; head < tail; ++head)
+        {
+            // The unvisited neighbours in increasing order of degree, then ID, sorted as (degree, ID) keys.
+            neighbours.clear();
+            for (uint32_t neighbour : graph.Edge(old_ids[head]))
+                if (!visited[neighbour])
+                {
+                    visited[neighbour] = true;
+                    uint64_t degree = std::min<uint64_t>(graph.Degree(neighbour), UINT32_MAX);
+                    neighbours.push_back(degree << 32 | neighbour);
+                }
+
+            IntroSort(neighbours.data(), neighbours.size());
+            for (uint64_t key : neighbours)
+                old_ids[tail++] = size_t(uint32_t(key));
+        }
+    }
+
+    Reverse(old_ids, vertex_count);
+}
+
+
+VertexOrder::VertexOrder(const CsrGraph& graph, VertexOrdering ordering) :
+    old_ids(new size_t[graph.VertexCount()]), new_ids(new uint32_t[graph.VertexCount()]), count(graph.VertexCount())
+{
+    switch (ordering)
+    {
+        case VertexOrdering::DEGREE:                DegreeOrder(graph, this->old_ids.get());              break;
+        case VertexOrdering::BREADTH_FIRST:         BreadthFirstOrder(graph, this->old_ids.get());        break;
+        case VertexOrdering::REVERSE_CUTHILL_MCKEE: ReverseCuthillMcKeeOrder(graph, this->old_ids.get()); break;
+        default: throw std::runtime_error("Unknown vertex ordering.");
+    }
+
+    for (size_t i = 0; i < this->count; ++i)
+        this->new_ids[this->old_ids[i]] = uint32_t(i);
+}
+
+void VertexOrder::TranslateToOld(uint32_t* ids, size_t count) const
+{
+    for (size_t i = 0; i < count; ++i)
+        if (ids[i] < this->count)
+            ids[i] = uint32_t(this->old_ids[ids[i]]);
+}
+
+CsrGraph VertexOrder::Relabel(const CsrGraph& graph, ThreadPool& pool) const
+{
+    if (graph.VertexCount() != this->count)
+        throw std::runtime_error("The order is for a graph with another number of vertices.");
+
+    const size_t vertex_count = this->count;
+
+    auto offsets    = std::shared_ptr<size_t[]>(new size_t[vertex_count + 1]);
+    auto neighbours = std::shared_ptr<uint32_t[]>(new uint32_t[graph.EdgeCount()]);
+
+    offsets[0] = 0;
+    for (size_t i = 0; i < vertex_count; ++i)
+        offsets[i + 1] = offsets[i] + graph.Degree(this->old_ids[i]);
+
+    ParallelFor(pool, 0, vertex_count, 1 << 12, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            NeighbourList list   = graph.Edge(this->old_ids[i]);
+            uint32_t*     output = neighbours.get() + offsets[i];
+
+            for (size_t j = 0; j < list.Count(); ++j)
+                output[j] = this->new_ids[list[j]];
+
+            IntroSort(output, list.Count());
+        }
+    });
+
+    // The graph views the two arrays, and keeps both alive.
+    struct Arrays
+    {
+        std::shared_ptr<size_t[]>   offsets;
+        std::shared_ptr<uint32_t[]> neighbours;
+    };
+    auto storage = std::make_shared<Arrays>(Arrays{ offsets, neighbours });
+
+    return CsrGraph(vertex_count, graph.EdgeCount(), offsets.get(), neighbours.get(), std::move(storage));
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "graphs.h"
+#include "sorting.h"
+#include "thread_pool.h"
+
+
+// Relabels the vertices of a graph so the ones that are traversed together get IDs close to each
+// other. A traversal then reads the per-vertex arrays (offsets, visited, parents, ...) in fewer cache
+// lines and pages than with IDs in arbitrary order.
+//  - DEGREE: highest degree first. The hubs, which most edges lead to, end up in a few hot cache lines.
+//  - BREADTH_FIRST: the order a BFS from the lowest unvisited ID reaches the vertices in, so every
+//    frontier is a nearly contiguous range.
+//  - REVERSE_CUTHILL_MCKEE: a BFS from a pseudo-peripheral vertex of every component that visits
+//    neighbours in increasing order of degree, reversed. It minimizes the bandwidth of the adjacency
+//    matrix, i.e. how far apart the IDs of neighbours are, and is the best fit for meshes, grids and
+//    road networks. It's meant for undirected graphs; on directed ones only the outgoing edges count.
+// https://en.wikipedia.org/wiki/Cuthill%E2%80%93McKee_algorithm
+enum class VertexOrdering
+{
+    DEGREE,
+    BREADTH_FIRST,
+    REVERSE_CUTHILL_MCKEE,
+};
+
+// A permutation of the vertices, with the translation both ways, to move a graph and its vertex
+// data to the new IDs and to translate queries and results between the old and new IDs.
+// Time Complexity: O(V log V + E) to compute.
+// Auxiliary Space: 12 bytes per vertex.
+class VertexOrder
+{
+public:
+    VertexOrder(const CsrGraph& graph, VertexOrdering ordering);
+
+    uint32_t ToNew(uint32_t old_id) const { return this->new_ids[old_id]; }
+    uint32_t ToOld(uint32_t new_id) const { return uint32_t(this->old_ids[new_id]); }
+
+    // Translates a list of new IDs (e.g. a path or the values of a parent array) to the old ones in
+    // place. Values that aren't vertices, such as NO_VERTEX, are left as they are.
+    void TranslateToOld(uint32_t* ids, size_t count) const;
+
+    // The graph with the new IDs, with every neighbour list sorted.
+    CsrGraph Relabel(const CsrGraph& graph, ThreadPool& pool = ThreadPool::Global()) const;
+
+    // output[new ID] = data[old ID], e.g. to move vertex weights along with the graph.
+    template <class T>
+    void Relabel(const T* data, T* output) const
+    {
+        ApplyPermutation(data, this->old_ids.get(), this->count, output);
+    }
+
+    // output[old ID] = data[new ID], e.g. to bring per-vertex results back to the old IDs.
+    template <class T>
+    void Restore(const T* data, T* output) const
+    {
+        for (size_t i = 0; i < this->count; ++i)
+            output[i] = data[this->new_ids[i]];
+    }
+
+    size_t Count() const noexcept { return this->count; }
+
+private:
+    unique_ptr<size_t[]>   old_ids;   // old_ids[new ID]
+    unique_ptr<uint32_t[]> new_ids;   // new_ids[old ID]
+    size_t count;
+};
@@ -1,175 +1,221 @@
-#include "utilities.h"
-#include "data_structures/dynamic_array.h"
-#include "data_structures/queue.h"
-#include "data_structures/stack.h"
+#include <cstdio>
+#include <filesystem>
 
+#include "graphs.h"
+#include "compressed_graph.h"
+#include "connected_components.h"
+#include "dynamic_graph.h"
+#include "graph_io.h"
+#include "graph_ordering.h"
+#include "parallel_bfs.h"
+#include "sparse_matrix.h"
+#include "spanning_forest.h"
 
-template <class V, class E>
-class Graph
-{
-public:
-    Graph(V* vertices, size_t vertex_count, E* edges, size_t edge_count) :
-        vertices(vertices), vertex_count(vertex_count), edges(edges), edge_count(edge_count)
-    {
-    }
-
-
-    V& Vertex(size_t i)  { return this->vertices[i]; }
-    E& Edge(size_t i)    { return this->edges[i];    }
-
-    const V& Vertex(size_t i) const { BoundsCheck(i, size_t(0), this->vertex_count); return this->vertices[i]; }
-    const E& Edge(size_t i)   const { BoundsCheck(i, size_t(0), this->edge_count);   return this->edges[i];    }
-
-    size_t VertexCount() const noexcept { return this->vertex_count; }
-    size_t EdgeCount()   const noexcept { return this->edge_count;   }
 
-private:
-    V* vertices;
-    size_t vertex_count;
+int main()
+{
+    using Node = size_t;
+    using Edge = DynamicArray<Node>;  // Adjacency list
 
-    E* edges;
-    size_t edge_count;
-};
+    Node vertices[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
 
+    // Undirected edges.
+    Edge edges[] = {
+            /* 0 */ {1, 7, 4},
+            /* 1 */ {0},
+            /* 2 */ {4, 8, 5},
+            /* 3 */ {5},
+            /* 4 */ {0, 2, 7, 8},
+            /* 5 */ {2, 8, 3, 6, 9},
+            /* 6 */ {6},
+            /* 7 */ {0, 4},
+            /* 8 */ {4, 2, 5},
+            /* 9 */ {5},
+    };
 
 
-template <class T>
-struct Node
-{
-    Node<T>* parent;
-    T        value;
+    const Graph<Node, Edge> graph(vertices, ARRAY_SIZE(vertices), edges, ARRAY_SIZE(edges));
 
-    Node() = default;
-    Node(Node<T>* parent, T value) : parent(parent), value(value) {}
-    Node<T>& operator= (const Node<T>& other)
     {
-        if (&other != this)
-        {
-            this->parent = other.parent;
-            this->value  = other.value;
-        }
-
-        return *this;
+        DynamicArray<Node> path = DepthFirstSearch(graph, Node(0), Node(9));
+        PrintArray(path.Raw(), path.Count());
     }
-};
 
+    {
+        DynamicArray<Node> path = BreadthFirstSearch<Queue>(graph, Node(0), Node(9));
+        PrintArray(path.Raw(), path.Count());
+    }
 
-template <class V, class E, class T>
-void DepthFirstSearchHelper(const Graph<V, E>& graph, V vertex, V target, T& visited, DynamicArray<V>& path, bool& found)
-{
-    if (visited[vertex])
-        return;
-    else
-        visited[vertex] = true;
+    const CsrGraph csr(graph);
 
-    if (vertex == target)
     {
-        found = true;
-        return;
+        DynamicArray<uint32_t> path = DepthFirstSearch(csr, uint32_t(0), uint32_t(9));
+        PrintArray(path.Raw(), path.Count());
     }
 
-    auto& neighbours = graph.Edge(vertex);
-    for (size_t j = 0; j < neighbours.Count(); ++j)
     {
-        DepthFirstSearchHelper(graph, neighbours[j], target, visited, path, found);
-        if (found)
-        {
-            path.Add(&neighbours[j], 1);
-            return;
-        }
+        DynamicArray<uint32_t> path = BreadthFirstSearch<Queue>(csr, uint32_t(0), uint32_t(9));
+        PrintArray(path.Raw(), path.Count());
     }
-}
-template <class V, class E>
-DynamicArray<V> DepthFirstSearch(const Graph<V, E>& graph, V start, V target)
-{
-    auto path    = DynamicArray<V>();
-    auto visited = make_unique<bool[]>(graph.VertexCount());
-
-    bool found = false;
-    DepthFirstSearchHelper(graph, start, target, visited, path, found);
 
-    if (found)
     {
-        path.Add(&start, 1);
-        Reverse(path.Raw(), path.Count());
-    }
+        auto parents = make_unique<uint32_t[]>(csr.VertexCount());
+        ParallelBreadthFirstSearch(csr, csr.Transposed(), 0, parents.get());
+        PrintArray(parents.get(), csr.VertexCount());
 
-    return path;
-}
+        const CsrGraph incoming = csr.Transposed();
 
-template <template<class> class DataStructure, class V, class E>
-DynamicArray<V> BreadthFirstSearch(const Graph<V, E>& graph, V start, V target)
-{
-    auto path    = DynamicArray<V>();
-    auto visited = make_unique<bool[]>(graph.VertexCount());
-    auto queue   = DataStructure<Node<V>>(graph.VertexCount());
+        BidirectionalSearchState state(csr.VertexCount());
+        uint32_t distance = BidirectionalBreadthFirstSearch(csr, incoming, 0, 9, state);
+        DynamicArray<uint32_t> path = state.Path();
+        printf("%u: ", distance);
+        PrintArray(path.Raw(), path.Count());
 
-    queue.Enqueue(nullptr, start);
-    visited[start] = true;
+        uint32_t sources[]   = { 0, 1, 2, 3 };
+        uint32_t targets[]   = { 9, 6, 0, 3 };
+        uint32_t distances[ARRAY_SIZE(sources)];
+        MultiSourceBreadthFirstSearch(csr, incoming, sources, targets, ARRAY_SIZE(sources), distances);
+        PrintArray(distances, ARRAY_SIZE(distances));
+    }
 
-    while (!queue.IsEmpty())
     {
-        auto& vertex = queue.Dequeue();
-
-        if (vertex.value == target)
-        {
-            path.Add(&vertex.value, 1);
-            while (vertex.parent != nullptr)
+        // The same edges, weighted by how far apart the vertices are on a line, so the distance left on
+        // the line is a heuristic that never overestimates.
+        DynamicArray<WeightedCsrEdge<int>> weighted_edges;
+        for (uint32_t i = 0; i < csr.VertexCount(); ++i)
+            for (uint32_t neighbour : csr.Edge(i))
             {
-                vertex = *vertex.parent;
-                path.Add(&vertex.value, 1);
+                WeightedCsrEdge<int> edge = { i, neighbour, abs(int(i) - int(neighbour)) };
+                weighted_edges.Add(&edge, 1);
             }
 
-            // Reverse so we get start to target, instead of target to start.
-            Reverse(path.Raw(), path.Count());
+        const WeightedCsrGraph<int> weighted(csr.VertexCount(), weighted_edges.Raw(), weighted_edges.Count());
+        ShortestPathState<int> state(weighted.VertexCount());
 
-            break;
-        }
+        int distance = Dijkstra(weighted, 0, 9, state);
+        DynamicArray<uint32_t> path = state.Path(9);
+        printf("%d: ", distance);
+        PrintArray(path.Raw(), path.Count());
 
-        auto& neighbours = graph.Edge(vertex.value);
-        for (size_t j = 0; j < neighbours.Count(); ++j)
-            if (!visited[neighbours[j]])
-            {
-                visited[neighbours[j]] = true;
-                queue.Enqueue(&vertex, neighbours[j]);
-            }
+        distance = AStar(weighted, 0, 9, [](uint32_t vertex) { return abs(9 - int(vertex)); }, state);
+        path = state.Path(9);
+        printf("%d: ", distance);
+        PrintArray(path.Raw(), path.Count());
     }
 
-    return path;
-}
+    {
+        auto components = make_unique<uint32_t[]>(csr.VertexCount());
+        size_t component_count = StronglyConnectedComponents(csr, components.get());
+        printf("%zu components: ", component_count);
+        PrintArray(components.get(), csr.VertexCount());
+
+        // Build steps, where an edge means the target depends on the source.
+        CsrEdge dependencies[] = { {0, 1}, {0, 2}, {1, 3}, {2, 3}, {3, 4}, {5, 4} };
+        const CsrGraph dag(6, dependencies, ARRAY_SIZE(dependencies));
+
+        uint32_t order[6];
+        if (TopologicalSort(dag, order))
+            PrintArray(order, ARRAY_SIZE(order));
+    }
 
+    {
+        // Undirected, so every edge is listed both ways.
+        CsrEdge links[] = { {0, 1}, {1, 0}, {1, 2}, {2, 1}, {3, 4}, {4, 3}, {6, 5}, {5, 6}, {5, 7}, {7, 5} };
+        const CsrGraph forest(8, links, ARRAY_SIZE(links));
+
+        uint32_t components[8];
+        std::vector<size_t> sizes;
+        size_t component_count = ConnectedComponents(forest, components, &sizes);
+        printf("%zu components: ", component_count);
+        PrintArray(components, ARRAY_SIZE(components));
+        PrintArray(sizes.data(), sizes.size());
+    }
 
-int main()
-{
-    using Node = size_t;
-    using Edge = DynamicArray<Node>;  // Adjacency list
+    {
+        // Undirected, so every edge is listed both ways.
+        WeightedCsrEdge<int> roads[] = {
+            {0, 1, 4}, {1, 0, 4}, {0, 2, 1}, {2, 0, 1}, {1, 2, 2}, {2, 1, 2},
+            {1, 3, 5}, {3, 1, 5}, {2, 3, 8}, {3, 2, 8}, {4, 5, 3}, {5, 4, 3},
+        };
+        const WeightedCsrGraph<int> network(6, roads, ARRAY_SIZE(roads));
+
+        for (const auto& forest : { Kruskal(network), Boruvka(network) })
+        {
+            for (size_t i = 0; i < forest.Count(); ++i)
+                printf("%u-%u (%d) ", forest[i].source, forest[i].target, forest[i].weight);
+            printf("\n");
+        }
+    }
 
-    Node vertices[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    {
+        double ranks[10];
+        size_t iterations = PageRank(csr, csr.Transposed(), ranks);
+        printf("%zu iterations: ", iterations);
+        for (double rank : ranks)
+            printf("%.3f ", rank);
+        printf("\n");
+    }
 
-    // Undirected edges.
-    Edge edges[] = {
-            /* 0 */ {1, 7, 4},
-            /* 1 */ {0},
-            /* 2 */ {4, 8, 5},
-            /* 3 */ {5},
-            /* 4 */ {0, 2, 7, 8},
-            /* 5 */ {2, 8, 3, 6, 9},
-            /* 6 */ {6},
-            /* 7 */ {0, 4},
-            /* 8 */ {4, 2, 5},
-            /* 9 */ {5},
-    };
+    {
+        // Search the relabelled graph, with the endpoints and the path translated between the IDs.
+        const VertexOrder order(csr, VertexOrdering::REVERSE_CUTHILL_MCKEE);
+        const CsrGraph relabelled = order.Relabel(csr);
 
+        DynamicArray<uint32_t> path = BreadthFirstSearch<Queue>(relabelled, order.ToNew(0), order.ToNew(9));
+        order.TranslateToOld(path.Raw(), path.Count());
+        PrintArray(path.Raw(), path.Count());
+    }
 
-    const Graph<Node, Edge> graph(vertices, ARRAY_SIZE(vertices), edges, ARRAY_SIZE(edges));
+    {
+        // Undirected, so every edge is inserted both ways.
+        DynamicGraph network(6);
+        CsrEdge links[] = { {0, 1}, {1, 0}, {1, 2}, {2, 1}, {3, 4}, {4, 3} };
+        network.Insert(links, ARRAY_SIZE(links));
+        printf("%zu components, 0-2 %s, 0-4 %s\n", network.ComponentCount(),
+               network.Connected(0, 2) ? "connected" : "apart", network.Connected(0, 4) ? "connected" : "apart");
+
+        CsrEdge bridge[] = { {2, 3}, {3, 2} };
+        network.Update(bridge, ARRAY_SIZE(bridge), links, 4);
+        DynamicArray<uint32_t> path = BreadthFirstSearch<Queue>(network, uint32_t(2), uint32_t(4));
+        printf("%zu components: ", network.ComponentCount());
+        PrintArray(path.Raw(), path.Count());
+    }
 
     {
-        DynamicArray<Node> path = DepthFirstSearch(graph, Node(0), Node(9));
+        // The same searches on the compressed lists, which are decoded as they're followed.
+        const CompressedCsrGraph compressed(csr);
+
+        DynamicArray<uint32_t> path = DepthFirstSearch(compressed, uint32_t(0), uint32_t(9));
+        PrintArray(path.Raw(), path.Count());
+        path = BreadthFirstSearch<Queue>(compressed, uint32_t(0), uint32_t(9));
         PrintArray(path.Raw(), path.Count());
+        printf("%zu bytes compressed, %zu bytes uncompressed\n", compressed.ByteCount(),
+               (csr.VertexCount() + 1) * sizeof(size_t) + csr.EdgeCount() * sizeof(uint32_t));
     }
 
     {
-        DynamicArray<Node> path = BreadthFirstSearch<Queue>(graph, Node(0), Node(9));
+        const auto snapshot_path = (std::filesystem::temp_directory_path() / "graph_snapshot.bin").string();
+        const auto edges_path    = (std::filesystem::temp_directory_path() / "graph_edges.txt").string();
+
+        SaveSnapshot(csr, snapshot_path.c_str());
+        const CsrGraph snapshot = LoadSnapshot(snapshot_path.c_str());
+
+        DynamicArray<uint32_t> path = BreadthFirstSearch<Queue>(snapshot, uint32_t(0), uint32_t(9));
         PrintArray(path.Raw(), path.Count());
+
+        // Sparse IDs, which are remapped to 0, 1 and 2.
+        FILE* file = fopen(edges_path.c_str(), "w");
+        fprintf(file, "# From\tTo\n1000\t70\n70\t123456789\n");
+        fclose(file);
+
+        std::vector<uint64_t> original_ids;
+        const CsrGraph loaded = LoadSnapEdgeList(edges_path.c_str(), false, &original_ids);
+        path = BreadthFirstSearch<Queue>(loaded, uint32_t(1), uint32_t(2));
+        for (size_t i = 0; i < path.Count(); ++i)
+            printf("%llu ", (unsigned long long) original_ids[path[i]]);
+        printf("\n");
+
+        std::remove(snapshot_path.c_str());
+        std::remove(edges_path.c_str());
     }
-}
\ No newline at end of file
+}
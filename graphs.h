@@ -0,0 +1,677 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+#include "utilities.h"
+#include "data_structures/dynamic_array.h"
+#include "data_structures/heap.h"
+#include "data_structures/queue.h"
+#include "data_structures/stack.h"
+
+
+template <class V, class E>
+class Graph
+{
+public:
+    Graph(V* vertices, size_t vertex_count, E* edges, size_t edge_count) :
+        vertices(vertices), vertex_count(vertex_count), edges(edges), edge_count(edge_count)
+    {
+    }
+
+
+    V& Vertex(size_t i)  { return this->vertices[i]; }
+    E& Edge(size_t i)    { return this->edges[i];    }
+
+    const V& Vertex(size_t i) const { BoundsCheck(i, size_t(0), this->vertex_count); return this->vertices[i]; }
+    const E& Edge(size_t i)   const { BoundsCheck(i, size_t(0), this->edge_count);   return this->edges[i];    }
+
+    size_t VertexCount() const noexcept { return this->vertex_count; }
+    size_t EdgeCount()   const noexcept { return this->edge_count;   }
+
+private:
+    V* vertices;
+    size_t vertex_count;
+
+    E* edges;
+    size_t edge_count;
+};
+
+
+
+// https://en.wikipedia.org/wiki/Sparse_matrix#Compressed_sparse_row_(CSR,_CRS_or_Yale_format)
+// The neighbours of every vertex are stored back to back in one array, and vertex i's neighbours are
+// neighbours[offsets[i], offsets[i + 1]). Compared to one 'DynamicArray' per vertex there's no pointer to
+// chase and no per-vertex allocation, so a traversal reads both arrays mostly sequentially. Vertex IDs
+// are 32-bit to halve the size of the (much larger) neighbour array; offsets are 64-bit so there can be
+// more than 2^32 edges.
+// The arrays are shared by copies of the graph, and can also be a view of memory owned by something
+// else, e.g. a mapped snapshot file.
+// Memory: 8 * (V + 1) + 4 * E bytes.
+struct CsrEdge
+{
+    uint32_t source;
+    uint32_t target;
+};
+
+// The neighbours of one vertex, with the same 'Count()' and 'operator[]' as the 'DynamicArray'
+// adjacency lists of 'Graph', so the searches work on both.
+class NeighbourList
+{
+public:
+    NeighbourList(const uint32_t* data, size_t count) : data(data), count(count) {}
+
+    [[nodiscard]] size_t Count() const noexcept { return this->count; }
+
+    const uint32_t& operator[] (size_t index) const { return this->data[index]; }
+
+    const uint32_t* begin() const noexcept { return this->data; }
+    const uint32_t* end()   const noexcept { return this->data + this->count; }
+
+private:
+    const uint32_t* data;
+    size_t count;
+};
+
+class CsrGraph
+{
+public:
+    using VertexId = uint32_t;
+
+    // Builds the graph from directed edges with a counting sort on the source, so the neighbours of
+    // each vertex keep the order they have in 'edges'.
+    CsrGraph(size_t vertex_count, const CsrEdge* edges, size_t edge_count) : CsrGraph(vertex_count, edge_count)
+    {
+        this->Fill(edges, [&](size_t position, const CsrEdge& edge) { this->neighbours[position] = edge.target; });
+    }
+
+    // Converts a graph with adjacency lists, where the vertex values are the IDs used in the lists.
+    template <class V, class E>
+    explicit CsrGraph(const Graph<V, E>& graph) : CsrGraph(graph.VertexCount(), CountEdges(graph))
+    {
+        for (size_t i = 0; i < this->vertex_count; ++i)
+            this->offsets[i + 1] = this->offsets[i] + graph.Edge(i).Count();
+
+        for (size_t i = 0; i < this->vertex_count; ++i)
+        {
+            const auto& list = graph.Edge(i);
+            for (size_t j = 0; j < list.Count(); ++j)
+            {
+                if (size_t(list[j]) >= this->vertex_count)
+                    throw std::runtime_error("Edge refers to a vertex that doesn't exist.");
+                this->neighbours[this->offsets[i] + j] = uint32_t(list[j]);
+            }
+        }
+    }
+
+    // The graph with every edge reversed, i.e. the incoming neighbours of each vertex. For an
+    // undirected graph, stored with both directions of every edge, it's the same graph.
+    CsrGraph Transposed() const
+    {
+        CsrGraph result(this->vertex_count, this->edge_count);
+
+        for (size_t i = 0; i < this->edge_count; ++i)
+            result.offsets[this->neighbours[i]] += 1;
+
+        ExclusivePrefixSum(result.offsets, this->vertex_count + 1);
+
+        for (size_t source = 0; source < this->vertex_count; ++source)
+            for (size_t i = this->offsets[source]; i < this->offsets[source + 1]; ++i)
+                result.neighbours[result.offsets[this->neighbours[i]]++] = uint32_t(source);
+
+        for (size_t i = this->vertex_count; i > 0; --i)
+            result.offsets[i] = result.offsets[i - 1];
+        result.offsets[0] = 0;
+
+        return result;
+    }
+
+    NeighbourList Edge(size_t i) const
+    {
+        DEBUG_BLOCK(BoundsCheck(i, size_t(0), this->vertex_count); );
+        return NeighbourList(this->neighbours + this->offsets[i], this->offsets[i + 1] - this->offsets[i]);
+    }
+
+    size_t Degree(size_t i) const { return this->offsets[i + 1] - this->offsets[i]; }
+
+    size_t VertexCount() const noexcept { return this->vertex_count; }
+    size_t EdgeCount()   const noexcept { return this->edge_count;   }
+
+    const size_t*   Offsets()    const noexcept { return this->offsets;    }
+    const uint32_t* Neighbours() const noexcept { return this->neighbours; }
+
+    // A graph over arrays that 'storage' keeps alive, without copying them. Only the ends of the
+    // offsets are checked, so the arrays must come from a valid graph.
+    CsrGraph(size_t vertex_count, size_t edge_count, const size_t* offsets, const uint32_t* neighbours, std::shared_ptr<const void> storage) :
+        offsets(const_cast<size_t*>(offsets)), neighbours(const_cast<uint32_t*>(neighbours)), storage(std::move(storage)),
+        vertex_count(vertex_count), edge_count(edge_count)
+    {
+        CheckVertexCount(vertex_count);
+        if (offsets[0] != 0 || offsets[vertex_count] != edge_count)
+            throw std::runtime_error("Offsets don't match the number of edges.");
+    }
+
+protected:
+    // Allocates the arrays, with all offsets 0.
+    CsrGraph(size_t vertex_count, size_t edge_count) : vertex_count(vertex_count), edge_count(edge_count)
+    {
+        CheckVertexCount(vertex_count);
+
+        auto arrays = std::make_shared<OwnedArrays>();
+        arrays->offsets    = make_unique<size_t[]>(vertex_count + 1);
+        arrays->neighbours = unique_ptr<uint32_t[]>(new uint32_t[edge_count]);
+
+        this->offsets    = arrays->offsets.get();
+        this->neighbours = arrays->neighbours.get();
+        this->storage    = std::move(arrays);
+    }
+
+    // Counting sorts 'edge_count' edges on their source, and calls 'place(position, edge)' with the
+    // index in the neighbour array every edge goes to.
+    template <class Edge, class Place>
+    void Fill(const Edge* edges, Place place)
+    {
+        for (size_t i = 0; i < this->edge_count; ++i)
+        {
+            if (edges[i].source >= this->vertex_count || edges[i].target >= this->vertex_count)
+                throw std::runtime_error("Edge refers to a vertex that doesn't exist.");
+            this->offsets[edges[i].source] += 1;
+        }
+
+        ExclusivePrefixSum(this->offsets, this->vertex_count + 1);
+
+        // Use offsets[source] as the insertion point of each vertex. Once all edges are placed it has
+        // moved to the end of the vertex, which is the start of the next one, so shift them all back.
+        for (size_t i = 0; i < this->edge_count; ++i)
+            place(this->offsets[edges[i].source]++, edges[i]);
+
+        for (size_t i = this->vertex_count; i > 0; --i)
+            this->offsets[i] = this->offsets[i - 1];
+        this->offsets[0] = 0;
+    }
+
+    static void CheckVertexCount(size_t vertex_count)
+    {
+        if (vertex_count > size_t(UINT32_MAX))
+            throw std::runtime_error("CsrGraph only supports 32-bit vertex IDs.");
+    }
+
+    template <class V, class E>
+    static size_t CountEdges(const Graph<V, E>& graph)
+    {
+        size_t edge_count = 0;
+        for (size_t i = 0; i < graph.VertexCount(); ++i)
+            edge_count += graph.Edge(i).Count();
+        return edge_count;
+    }
+
+    struct OwnedArrays
+    {
+        unique_ptr<size_t[]>   offsets;
+        unique_ptr<uint32_t[]> neighbours;
+    };
+
+    // Only written while the graph is built.
+    size_t*   offsets;
+    uint32_t* neighbours;
+    std::shared_ptr<const void> storage;   // Keeps the arrays alive, whoever owns them.
+
+    size_t vertex_count;
+    size_t edge_count;
+};
+
+
+// A 'CsrGraph' with a weight per edge, stored in an array parallel to the neighbours. The weights of
+// vertex i's edges are Weights(i)[0, Edge(i).Count()).
+template <class W>
+struct WeightedCsrEdge
+{
+    uint32_t source;
+    uint32_t target;
+    W        weight;
+};
+
+template <class W>
+class WeightedCsrGraph : public CsrGraph
+{
+public:
+    using Weight = W;
+
+    WeightedCsrGraph(size_t vertex_count, const WeightedCsrEdge<W>* edges, size_t edge_count) :
+        CsrGraph(vertex_count, edge_count), weights(new W[edge_count])
+    {
+        this->Fill(edges, [&](size_t position, const WeightedCsrEdge<W>& edge)
+        {
+            this->neighbours[position] = edge.target;
+            this->weights[position]    = edge.weight;
+        });
+    }
+
+    const W* Weights(size_t i) const { return this->weights.get() + this->Offsets()[i]; }
+    const W* Weights()   const noexcept { return this->weights.get(); }
+
+private:
+    unique_ptr<W[]> weights;
+};
+
+
+
+template <class T>
+struct Node
+{
+    Node<T>* parent;
+    T        value;
+
+    Node() = default;
+    Node(Node<T>* parent, T value) : parent(parent), value(value) {}
+    Node<T>& operator= (const Node<T>& other)
+    {
+        if (&other != this)
+        {
+            this->parent = other.parent;
+            this->value  = other.value;
+        }
+
+        return *this;
+    }
+};
+
+
+// The searches work on any graph with 'VertexCount()' and an 'Edge(i)' that returns the neighbour list
+// of vertex i, i.e. 'Graph', 'CsrGraph' and 'CompressedCsrGraph'. They only walk the lists from
+// 'begin()' to 'end()', so a list can decode its neighbours as it goes instead of storing them.
+//
+// The depth first searches don't recurse, so a long path can't overflow the call stack. Instead they
+// keep a 'Stack' of frames, each with a vertex and a cursor to the next of its edges to follow, which
+// is what a recursive call would keep on the call stack. Every vertex is pushed at most once, so the
+// stack never holds more than V frames, and the frames on it are always the path from the start.
+// The cursors point into the graph, not into the list 'Edge' returned, so they outlive it.
+template <class G>
+using NeighbourCursor = decltype(std::declval<const G&>().Edge(0).begin());
+
+template <class V, class Cursor>
+struct DepthFirstFrame
+{
+    V      vertex;
+    Cursor next;
+
+    DepthFirstFrame() = default;
+    DepthFirstFrame(V vertex, Cursor next) : vertex(vertex), next(next) {}
+};
+
+template <class G, class V>
+DynamicArray<V> DepthFirstSearch(const G& graph, V start, V target)
+{
+    auto path    = DynamicArray<V>();
+    auto visited = make_unique<bool[]>(graph.VertexCount());
+    auto stack   = Stack<DepthFirstFrame<V, NeighbourCursor<G>>>(graph.VertexCount());
+
+    visited[start] = true;
+    stack.Push(start, graph.Edge(start).begin());
+
+    bool found = (start == target);
+    while (!found && !stack.IsEmpty())
+    {
+        auto& frame = stack.Top();
+
+        if (frame.next == graph.Edge(frame.vertex).end())
+        {
+            stack.Pop();
+            continue;
+        }
+
+        V neighbour = V(*frame.next);
+        ++frame.next;
+        if (visited[neighbour])
+            continue;
+
+        visited[neighbour] = true;
+        stack.Push(neighbour, graph.Edge(neighbour).begin());
+        found = (neighbour == target);
+    }
+
+    if (found)
+        while (!stack.IsEmpty())
+            path.Add(&stack.Pop().vertex, 1);
+
+    Reverse(path.Raw(), path.Count());
+    return path;
+}
+
+template <template<class> class DataStructure, class G, class V>
+DynamicArray<V> BreadthFirstSearch(const G& graph, V start, V target)
+{
+    auto path    = DynamicArray<V>();
+    auto visited = make_unique<bool[]>(graph.VertexCount());
+    auto queue   = DataStructure<Node<V>>(graph.VertexCount());
+
+    queue.Enqueue(nullptr, start);
+    visited[start] = true;
+
+    while (!queue.IsEmpty())
+    {
+        auto& vertex = queue.Dequeue();
+
+        if (vertex.value == target)
+        {
+            path.Add(&vertex.value, 1);
+            while (vertex.parent != nullptr)
+            {
+                vertex = *vertex.parent;
+                path.Add(&vertex.value, 1);
+            }
+
+            // Reverse so we get start to target, instead of target to start.
+            Reverse(path.Raw(), path.Count());
+
+            break;
+        }
+
+        for (V neighbour : graph.Edge(vertex.value))
+            if (!visited[neighbour])
+            {
+                visited[neighbour] = true;
+                queue.Enqueue(&vertex, neighbour);
+            }
+    }
+
+    return path;
+}
+
+
+// https://en.wikipedia.org/wiki/Tarjan%27s_strongly_connected_components_algorithm
+// Writes the component of every vertex to 'components' and returns the number of components. They're
+// numbered in reverse topological order: an edge between two components always goes from a higher
+// number to a lower one (or stays within one).
+// Each vertex gets the order it was discovered in, and 'lowest' is the earliest vertex on the
+// component stack it can reach. A vertex that can't reach anything earlier than itself is the root of
+// a component, which is everything above it on the component stack.
+// Time Complexity: O(V + E)
+// Auxiliary Space: O(V)
+template <class G>
+size_t StronglyConnectedComponents(const G& graph, uint32_t* components)
+{
+    using V = size_t;
+    constexpr uint32_t UNVISITED = UINT32_MAX;
+
+    const size_t vertex_count = graph.VertexCount();
+    if (vertex_count >= size_t(UNVISITED))
+        throw std::runtime_error("Too many vertices for 32-bit component IDs.");
+
+    auto order   = unique_ptr<uint32_t[]>(new uint32_t[vertex_count]);
+    auto lowest  = unique_ptr<uint32_t[]>(new uint32_t[vertex_count]);
+    auto stack   = Stack<DepthFirstFrame<V, NeighbourCursor<G>>>(vertex_count);
+    auto pending = Stack<V>(vertex_count);   // Visited vertices that aren't in a component yet.
+
+    for (size_t i = 0; i < vertex_count; ++i)
+    {
+        order[i]      = UNVISITED;
+        components[i] = UNVISITED;
+    }
+
+    uint32_t next_order     = 0;
+    uint32_t next_component = 0;
+
+    for (V root = 0; root < vertex_count; ++root)
+    {
+        if (order[root] != UNVISITED)
+            continue;
+
+        order[root] = lowest[root] = next_order++;
+        pending.Push(root);
+        stack.Push(root, graph.Edge(root).begin());
+
+        while (!stack.IsEmpty())
+        {
+            auto& frame = stack.Top();
+            V vertex = frame.vertex;
+
+            if (frame.next != graph.Edge(vertex).end())
+            {
+                V neighbour = V(*frame.next);
+                ++frame.next;
+
+                if (order[neighbour] == UNVISITED)
+                {
+                    order[neighbour] = lowest[neighbour] = next_order++;
+                    pending.Push(neighbour);
+                    stack.Push(neighbour, graph.Edge(neighbour).begin());
+                }
+                else if (components[neighbour] == UNVISITED)   // Still on the component stack.
+                {
+                    lowest[vertex] = std::min(lowest[vertex], order[neighbour]);
+                }
+                continue;
+            }
+
+            stack.Pop();
+            if (!stack.IsEmpty())
+            {
+                V parent = stack.Top().vertex;
+                lowest[parent] = std::min(lowest[parent], lowest[vertex]);
+            }
+
+            if (lowest[vertex] == order[vertex])
+            {
+                V member;
+                do
+                {
+                    member = pending.Pop();
+                    components[member] = next_component;
+                }
+                while (member != vertex);
+
+                ++next_component;
+            }
+        }
+    }
+
+    return next_component;
+}
+
+// https://en.wikipedia.org/wiki/Topological_sorting#Depth-first_search
+// Writes the vertices to 'order' so every edge goes from an earlier vertex to a later one. A vertex
+// goes in front of everything already placed once all of its edges are done. Returns false, leaving
+// 'order' unspecified, if the graph has a cycle, i.e. an edge back to a vertex that's still on the stack.
+// Time Complexity: O(V + E)
+// Auxiliary Space: O(V)
+template <class G>
+bool TopologicalSort(const G& graph, uint32_t* order)
+{
+    using V = size_t;
+    enum class State : uint8_t { UNVISITED, ON_STACK, DONE };
+
+    const size_t vertex_count = graph.VertexCount();
+    if (vertex_count > size_t(UINT32_MAX))
+        throw std::runtime_error("Too many vertices for 32-bit vertex IDs.");
+
+    auto state = unique_ptr<State[]>(new State[vertex_count]);
+    auto stack = Stack<DepthFirstFrame<V, NeighbourCursor<G>>>(vertex_count);
+
+    for (size_t i = 0; i < vertex_count; ++i)
+        state[i] = State::UNVISITED;
+
+    size_t placed = vertex_count;
+
+    for (V root = 0; root < vertex_count; ++root)
+    {
+        if (state[root] != State::UNVISITED)
+            continue;
+
+        state[root] = State::ON_STACK;
+        stack.Push(root, graph.Edge(root).begin());
+
+        while (!stack.IsEmpty())
+        {
+            auto& frame = stack.Top();
+
+            if (frame.next != graph.Edge(frame.vertex).end())
+            {
+                V neighbour = V(*frame.next);
+                ++frame.next;
+
+                if (state[neighbour] == State::ON_STACK)
+                    return false;
+
+                if (state[neighbour] == State::UNVISITED)
+                {
+                    state[neighbour] = State::ON_STACK;
+                    stack.Push(neighbour, graph.Edge(neighbour).begin());
+                }
+                continue;
+            }
+
+            state[frame.vertex] = State::DONE;
+            order[--placed] = uint32_t(frame.vertex);
+            stack.Pop();
+        }
+    }
+
+    return true;
+}
+
+
+// Reusable state of the shortest path searches: the distances, the shortest path tree and the heap.
+// Instead of clearing V distances before every query, each vertex has the number of the query that
+// last reached it, and anything with an older number counts as unreached. Starting a query is then
+// O(1) plus the size of the heap left over by an early exit, which matters when thousands of
+// point-to-point queries each only touch a small part of a big graph.
+constexpr uint32_t NO_VERTEX = UINT32_MAX;
+
+template <class W>
+class ShortestPathState
+{
+public:
+    constexpr static W UNREACHABLE = std::numeric_limits<W>::max();
+
+    explicit ShortestPathState(size_t vertex_count) :
+        distances(new W[vertex_count]), parents(new uint32_t[vertex_count]), queries(make_unique<uint32_t[]>(vertex_count)),
+        query(0), heap(vertex_count), vertex_count(vertex_count)
+    {
+    }
+
+    void Reset()
+    {
+        this->heap.Clear();
+
+        // Every 2^32 queries the numbers wrap around, and old ones could look current.
+        if (++this->query == 0)
+        {
+            for (size_t i = 0; i < this->vertex_count; ++i)
+                this->queries[i] = 0;
+            this->query = 1;
+        }
+    }
+
+    bool IsReached(uint32_t vertex) const { return this->queries[vertex] == this->query; }
+
+    W        Distance(uint32_t vertex) const { return this->IsReached(vertex) ? this->distances[vertex] : UNREACHABLE; }
+    uint32_t Parent(uint32_t vertex)   const { return this->IsReached(vertex) ? this->parents[vertex]   : NO_VERTEX;   }
+
+    void Reach(uint32_t vertex, W distance, uint32_t parent)
+    {
+        this->distances[vertex] = distance;
+        this->parents[vertex]   = parent;
+        this->queries[vertex]   = this->query;
+    }
+
+    // The vertices from the source to 'target', or nothing if it wasn't reached.
+    DynamicArray<uint32_t> Path(uint32_t target) const
+    {
+        auto path = DynamicArray<uint32_t>();
+        if (!this->IsReached(target))
+            return path;
+
+        uint32_t vertex = target;
+        path.Add(&vertex, 1);
+        while (this->parents[vertex] != vertex)
+        {
+            vertex = this->parents[vertex];
+            path.Add(&vertex, 1);
+        }
+
+        Reverse(path.Raw(), path.Count());
+        return path;
+    }
+
+    IndexedMinHeap<W>& Heap() noexcept { return this->heap; }
+
+    size_t VertexCount() const noexcept { return this->vertex_count; }
+
+private:
+    unique_ptr<W[]>        distances;
+    unique_ptr<uint32_t[]> parents;
+    unique_ptr<uint32_t[]> queries;
+    uint32_t query;
+
+    IndexedMinHeap<W> heap;
+    size_t vertex_count;
+};
+
+// https://en.wikipedia.org/wiki/A*_search_algorithm
+// Dijkstra's algorithm that pops vertices in order of distance plus 'heuristic(vertex)', an estimate
+// of the distance left to 'target'. The search stops as soon as 'target' is popped; with NO_VERTEX
+// as target it runs until every reachable vertex is settled. Weights must not be negative.
+// If the heuristic never overestimates, the distance is the shortest one. Vertices whose distance
+// improves after they were popped, which only happens if the heuristic isn't consistent, are pushed
+// again.
+// Returns the distance to 'target', or UNREACHABLE. The tree is left in 'state'.
+// Time Complexity: O((V + E) log V), for the vertices and edges actually visited.
+// Auxiliary Space: O(V), in 'state'.
+template <class W, class Heuristic>
+W AStar(const WeightedCsrGraph<W>& graph, uint32_t source, uint32_t target, Heuristic heuristic, ShortestPathState<W>& state)
+{
+    if (state.VertexCount() != graph.VertexCount())
+        throw std::runtime_error("Search state has the wrong size for the graph.");
+    if (source >= graph.VertexCount() || (target != NO_VERTEX && target >= graph.VertexCount()))
+        throw std::runtime_error("Vertex doesn't exist.");
+
+    const size_t*   offsets    = graph.Offsets();
+    const uint32_t* neighbours = graph.Neighbours();
+    const W*        weights    = graph.Weights();
+
+    state.Reset();
+    IndexedMinHeap<W>& heap = state.Heap();
+
+    state.Reach(source, W(0), source);
+    heap.Push(source, heuristic(source));
+
+    while (!heap.IsEmpty())
+    {
+        uint32_t vertex = heap.Pop();
+        if (vertex == target)
+            return state.Distance(vertex);
+
+        W distance = state.Distance(vertex);
+        for (size_t j = offsets[vertex]; j < offsets[vertex + 1]; ++j)
+        {
+            uint32_t neighbour    = neighbours[j];
+            W        new_distance = distance + weights[j];
+
+            if (!state.IsReached(neighbour) || new_distance < state.Distance(neighbour))
+            {
+                state.Reach(neighbour, new_distance, vertex);
+                heap.PushOrDecreaseKey(neighbour, new_distance + heuristic(neighbour));
+            }
+        }
+    }
+
+    return (target == NO_VERTEX) ? W(0) : ShortestPathState<W>::UNREACHABLE;
+}
+
+// https://en.wikipedia.org/wiki/Dijkstra%27s_algorithm
+// A* without a heuristic. Returns the distance to 'target', or UNREACHABLE.
+template <class W>
+W Dijkstra(const WeightedCsrGraph<W>& graph, uint32_t source, uint32_t target, ShortestPathState<W>& state)
+{
+    return AStar(graph, source, target, [](uint32_t) { return W(0); }, state);
+}
+
+// The distances from 'source' to every vertex, in 'state'.
+template <class W>
+void Dijkstra(const WeightedCsrGraph<W>& graph, uint32_t source, ShortestPathState<W>& state)
+{
+    AStar(graph, source, NO_VERTEX, [](uint32_t) { return W(0); }, state);
+}
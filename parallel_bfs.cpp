@@ -0,0 +1,509 @@
+#include "parallel_bfs.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "data_structures/bitmap.h"
+
+
+// Appends the vertices a task found to the shared next frontier with a single atomic add.
+static void AppendToQueue(std::atomic<size_t>& queue_count, uint32_t* queue, const std::vector<uint32_t>& vertices)
+{
+    if (vertices.empty())
+        return;
+
+    size_t at = queue_count.fetch_add(vertices.size(), std::memory_order_relaxed);
+    memcpy(queue + at, vertices.data(), vertices.size() * sizeof(uint32_t));
+}
+
+// Returns the size of the next frontier, and the number of edges going out of it in 'scout_count'.
+static size_t TopDownStep(ThreadPool& pool, const CsrGraph& graph, const uint32_t* frontier, size_t frontier_count,
+                          uint32_t* next, Bitmap& visited, uint32_t* parents, size_t& scout_count)
+{
+    const size_t*   offsets    = graph.Offsets();
+    const uint32_t* neighbours = graph.Neighbours();
+
+    std::atomic<size_t> next_count(0);
+    std::atomic<size_t> scout(0);
+
+    ParallelFor(pool, 0, frontier_count, BFS_GRAIN_SIZE, [&](size_t begin, size_t end)
+    {
+        std::vector<uint32_t> found;
+        size_t local_scout = 0;
+
+        for (size_t i = begin; i < end; ++i)
+        {
+            uint32_t u = frontier[i];
+            for (size_t j = offsets[u]; j < offsets[u + 1]; ++j)
+            {
+                uint32_t v = neighbours[j];
+                if (visited.TrySet(v))
+                {
+                    parents[v] = u;
+                    found.push_back(v);
+                    local_scout += offsets[v + 1] - offsets[v];
+                }
+            }
+        }
+
+        AppendToQueue(next_count, next, found);
+        scout.fetch_add(local_scout, std::memory_order_relaxed);
+    });
+
+    scout_count = scout.load(std::memory_order_relaxed);
+    return next_count.load(std::memory_order_relaxed);
+}
+
+// Returns the size of the next frontier.
+static size_t BottomUpStep(ThreadPool& pool, const CsrGraph& incoming, const Bitmap& frontier, Bitmap& next,
+                           Bitmap& visited, uint32_t* parents)
+{
+    const size_t*   offsets      = incoming.Offsets();
+    const uint32_t* neighbours   = incoming.Neighbours();
+    const size_t    vertex_count = incoming.VertexCount();
+
+    std::atomic<size_t> awake(0);
+
+    ParallelFor(pool, 0, visited.WordCount(), BFS_GRAIN_SIZE, [&](size_t begin, size_t end)
+    {
+        size_t local_awake = 0;
+
+        for (size_t w = begin; w < end; ++w)
+        {
+            uint64_t unvisited = ~visited.Word(w);
+            size_t   first     = w * Bitmap::BITS_PER_WORD;
+            if (vertex_count - first < Bitmap::BITS_PER_WORD)
+                unvisited &= (uint64_t(1) << (vertex_count - first)) - 1;
+
+            uint64_t found = 0;
+            for (; unvisited != 0; unvisited &= unvisited - 1)
+            {
+                size_t   bit = __builtin_ctzll(unvisited);
+                uint32_t v   = uint32_t(first + bit);
+
+                for (size_t j = offsets[v]; j < offsets[v + 1]; ++j)
+                    if (frontier.Get(neighbours[j]))
+                    {
+                        parents[v] = neighbours[j];
+                        found |= uint64_t(1) << bit;
+                        break;
+                    }
+            }
+
+            next.SetWord(w, found);
+            if (found != 0)
+            {
+                visited.SetWord(w, visited.Word(w) | found);
+                local_awake += __builtin_popcountll(found);
+            }
+        }
+
+        awake.fetch_add(local_awake, std::memory_order_relaxed);
+    });
+
+    return awake.load(std::memory_order_relaxed);
+}
+
+static void QueueToBitmap(ThreadPool& pool, const uint32_t* queue, size_t queue_count, Bitmap& bitmap)
+{
+    bitmap.Clear();
+    ParallelFor(pool, 0, queue_count, BFS_GRAIN_SIZE, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+            bitmap.TrySet(queue[i]);
+    });
+}
+
+static size_t BitmapToQueue(ThreadPool& pool, const Bitmap& bitmap, uint32_t* queue)
+{
+    std::atomic<size_t> queue_count(0);
+
+    ParallelFor(pool, 0, bitmap.WordCount(), BFS_GRAIN_SIZE, [&](size_t begin, size_t end)
+    {
+        std::vector<uint32_t> found;
+        for (size_t w = begin; w < end; ++w)
+            for (uint64_t bits = bitmap.Word(w); bits != 0; bits &= bits - 1)
+                found.push_back(uint32_t(w * Bitmap::BITS_PER_WORD + __builtin_ctzll(bits)));
+
+        AppendToQueue(queue_count, queue, found);
+    });
+
+    return queue_count.load(std::memory_order_relaxed);
+}
+
+
+size_t ParallelBreadthFirstSearch(const CsrGraph& graph, const CsrGraph& incoming, uint32_t source, uint32_t* parents, ThreadPool& pool)
+{
+    const size_t vertex_count = graph.VertexCount();
+
+    if (incoming.VertexCount() != vertex_count || incoming.EdgeCount() != graph.EdgeCount())
+        throw std::runtime_error("The incoming edges don't belong to the graph.");
+    if (source >= vertex_count)
+        throw std::runtime_error("Source vertex doesn't exist.");
+
+    ParallelFor(pool, 0, vertex_count, BFS_GRAIN_SIZE * Bitmap::BITS_PER_WORD, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+            parents[i] = BFS_NO_PARENT;
+    });
+
+    Bitmap visited(vertex_count);
+    Bitmap frontier(vertex_count);
+    Bitmap next(vertex_count);
+
+    auto queue      = unique_ptr<uint32_t[]>(new uint32_t[vertex_count]);
+    auto next_queue = unique_ptr<uint32_t[]>(new uint32_t[vertex_count]);
+
+    parents[source] = source;
+    visited.Set(source);
+    queue[0] = source;
+
+    size_t queue_count    = 1;
+    size_t reached        = 1;
+    size_t edges_to_check = graph.EdgeCount();
+    size_t scout_count    = graph.Degree(source);
+
+    while (queue_count != 0)
+    {
+        if (scout_count > edges_to_check / BFS_ALPHA)
+        {
+            QueueToBitmap(pool, queue.get(), queue_count, frontier);
+
+            size_t awake = queue_count;
+            size_t previous_awake;
+            do
+            {
+                previous_awake = awake;
+                awake = BottomUpStep(pool, incoming, frontier, next, visited, parents);
+                frontier.Swap(next);
+                reached += awake;
+            }
+            while (awake >= previous_awake || awake > vertex_count / BFS_BETA);
+
+            queue_count = BitmapToQueue(pool, frontier, queue.get());
+            scout_count = 1;
+        }
+        else
+        {
+            edges_to_check -= std::min(scout_count, edges_to_check);
+            queue_count = TopDownStep(pool, graph, queue.get(), queue_count, next_queue.get(), visited, parents, scout_count);
+            queue.swap(next_queue);
+            reached += queue_count;
+        }
+    }
+
+    return reached;
+}
+
+size_t ParallelBreadthFirstSearch(const CsrGraph& graph, uint32_t source, uint32_t* parents, ThreadPool& pool)
+{
+    return ParallelBreadthFirstSearch(graph, graph, source, parents, pool);
+}
+
+
+BidirectionalSearchState::BidirectionalSearchState(size_t vertex_count) :
+    query(0), meeting(NO_VERTEX), vertex_count(vertex_count)
+{
+    for (Side* side : { &this->forward, &this->backward })
+    {
+        side->queries   = make_unique<uint32_t[]>(vertex_count);
+        side->distances = unique_ptr<uint32_t[]>(new uint32_t[vertex_count]);
+        side->parents   = unique_ptr<uint32_t[]>(new uint32_t[vertex_count]);
+        side->queue     = unique_ptr<uint32_t[]>(new uint32_t[vertex_count]);
+    }
+}
+
+DynamicArray<uint32_t> BidirectionalSearchState::Path() const
+{
+    auto path = DynamicArray<uint32_t>();
+    if (this->meeting == NO_VERTEX)
+        return path;
+
+    // The forward tree from the meeting vertex back to the source, reversed...
+    uint32_t vertex = this->meeting;
+    path.Add(&vertex, 1);
+    while (this->forward.parents[vertex] != vertex)
+    {
+        vertex = this->forward.parents[vertex];
+        path.Add(&vertex, 1);
+    }
+    Reverse(path.Raw(), path.Count());
+
+    // ...followed by the backward tree from the meeting vertex to the target.
+    vertex = this->meeting;
+    while (this->backward.parents[vertex] != vertex)
+    {
+        vertex = this->backward.parents[vertex];
+        path.Add(&vertex, 1);
+    }
+
+    return path;
+}
+
+uint32_t BidirectionalBreadthFirstSearch(const CsrGraph& graph, const CsrGraph& incoming, uint32_t source, uint32_t target,
+                                         BidirectionalSearchState& state)
+{
+    using Side = BidirectionalSearchState::Side;
+
+    const size_t vertex_count = graph.VertexCount();
+    if (incoming.VertexCount() != vertex_count || state.VertexCount() != vertex_count)
+        throw std::runtime_error("The incoming edges or the search state don't belong to the graph.");
+    if (source >= vertex_count || target >= vertex_count)
+        throw std::runtime_error("Vertex doesn't exist.");
+
+    // Every 2^32 queries the numbers wrap around, and old ones could look current.
+    if (++state.query == 0)
+    {
+        memset(state.forward.queries.get(),  0, vertex_count * sizeof(uint32_t));
+        memset(state.backward.queries.get(), 0, vertex_count * sizeof(uint32_t));
+        state.query = 1;
+    }
+
+    const uint32_t query = state.query;
+    auto reach = [query](Side& side, size_t& end, uint32_t vertex, uint32_t distance, uint32_t parent)
+    {
+        side.queries[vertex]   = query;
+        side.distances[vertex] = distance;
+        side.parents[vertex]   = parent;
+        side.queue[end++]      = vertex;
+    };
+
+    size_t forward_begin  = 0, forward_end  = 0;
+    size_t backward_begin = 0, backward_end = 0;
+    reach(state.forward,  forward_end,  source, 0, source);
+    reach(state.backward, backward_end, target, 0, target);
+
+    if (source == target)
+    {
+        state.meeting = source;
+        return 0;
+    }
+
+    state.meeting = NO_VERTEX;
+
+    size_t   forward_edges  = graph.Degree(source);
+    size_t   backward_edges = incoming.Degree(target);
+    uint32_t best           = BFS_UNREACHABLE;
+
+    while (forward_begin < forward_end && backward_begin < backward_end)
+    {
+        const bool is_forward = forward_edges <= backward_edges;
+
+        const CsrGraph& edges  = is_forward ? graph          : incoming;
+        Side&           side   = is_forward ? state.forward  : state.backward;
+        const Side&     other  = is_forward ? state.backward : state.forward;
+        size_t&         begin  = is_forward ? forward_begin  : backward_begin;
+        size_t&         end    = is_forward ? forward_end    : backward_end;
+        size_t&         frontier_edges = is_forward ? forward_edges : backward_edges;
+
+        const size_t*   offsets    = edges.Offsets();
+        const uint32_t* neighbours = edges.Neighbours();
+
+        // Expand the whole level, and take the best of all the meetings in it.
+        size_t level_end = end;
+        frontier_edges = 0;
+
+        for (; begin < level_end; ++begin)
+        {
+            uint32_t vertex   = side.queue[begin];
+            uint32_t distance = side.distances[vertex] + 1;
+
+            for (size_t j = offsets[vertex]; j < offsets[vertex + 1]; ++j)
+            {
+                uint32_t neighbour = neighbours[j];
+                if (side.queries[neighbour] != query)
+                {
+                    reach(side, end, neighbour, distance, vertex);
+                    frontier_edges += offsets[neighbour + 1] - offsets[neighbour];
+                }
+
+                if (other.queries[neighbour] == query)
+                {
+                    uint32_t length = side.distances[neighbour] + other.distances[neighbour];
+                    if (length < best)
+                    {
+                        best          = length;
+                        state.meeting = neighbour;
+                    }
+                }
+            }
+        }
+
+        if (best != BFS_UNREACHABLE)
+            return best;
+    }
+
+    return BFS_UNREACHABLE;
+}
+
+uint32_t BidirectionalBreadthFirstSearch(const CsrGraph& graph, uint32_t source, uint32_t target, BidirectionalSearchState& state)
+{
+    return BidirectionalBreadthFirstSearch(graph, graph, source, target, state);
+}
+
+
+// A bit per query of a multi-source BFS batch.
+template <size_t WORDS>
+struct LaneSet
+{
+    uint64_t words[WORDS];
+
+    void Set(size_t lane)   { this->words[lane / 64] |=  (uint64_t(1) << (lane % 64)); }
+    void Reset(size_t lane) { this->words[lane / 64] &= ~(uint64_t(1) << (lane % 64)); }
+
+    bool Test(size_t lane) const { return (this->words[lane / 64] >> (lane % 64)) & 1; }
+
+    bool Any() const
+    {
+        uint64_t any = 0;
+        for (size_t w = 0; w < WORDS; ++w)
+            any |= this->words[w];
+        return any != 0;
+    }
+
+    LaneSet& operator|= (const LaneSet& other)
+    {
+        for (size_t w = 0; w < WORDS; ++w)
+            this->words[w] |= other.words[w];
+        return *this;
+    }
+
+    LaneSet& operator&= (const LaneSet& other)
+    {
+        for (size_t w = 0; w < WORDS; ++w)
+            this->words[w] &= other.words[w];
+        return *this;
+    }
+
+    // The lanes in 'a' that aren't in 'b'.
+    static LaneSet Difference(const LaneSet& a, const LaneSet& b)
+    {
+        LaneSet result;
+        for (size_t w = 0; w < WORDS; ++w)
+            result.words[w] = a.words[w] & ~b.words[w];
+        return result;
+    }
+};
+
+template <size_t WORDS>
+static void MultiSourceBatch(ThreadPool& pool, const CsrGraph& incoming, const uint32_t* sources, const uint32_t* targets,
+                             size_t count, uint32_t* distances, LaneSet<WORDS>* seen, LaneSet<WORDS>* visit, LaneSet<WORDS>* next)
+{
+    const size_t    vertex_count = incoming.VertexCount();
+    const size_t*   offsets      = incoming.Offsets();
+    const uint32_t* neighbours   = incoming.Neighbours();
+
+    ParallelFor(pool, 0, vertex_count, BFS_GRAIN_SIZE, [&](size_t begin, size_t end)
+    {
+        for (size_t v = begin; v < end; ++v)
+            seen[v] = visit[v] = LaneSet<WORDS>{};
+    });
+
+    LaneSet<WORDS> active{};
+    for (size_t lane = 0; lane < count; ++lane)
+    {
+        if (sources[lane] == targets[lane])
+        {
+            distances[lane] = 0;
+            continue;
+        }
+
+        distances[lane] = BFS_UNREACHABLE;
+        active.Set(lane);
+        seen[sources[lane]].Set(lane);
+        visit[sources[lane]].Set(lane);
+    }
+
+    for (uint32_t level = 1; active.Any(); ++level)
+    {
+        std::atomic<bool> progress(false);
+
+        ParallelFor(pool, 0, vertex_count, BFS_GRAIN_SIZE, [&](size_t begin, size_t end)
+        {
+            bool local_progress = false;
+
+            for (size_t v = begin; v < end; ++v)
+            {
+                LaneSet<WORDS> unseen = LaneSet<WORDS>::Difference(active, seen[v]);
+                if (!unseen.Any())
+                {
+                    next[v] = LaneSet<WORDS>{};
+                    continue;
+                }
+
+                LaneSet<WORDS> reached{};
+                for (size_t j = offsets[v]; j < offsets[v + 1]; ++j)
+                    reached |= visit[neighbours[j]];
+                reached &= unseen;
+
+                next[v] = reached;
+                if (reached.Any())
+                {
+                    seen[v] |= reached;
+                    local_progress = true;
+                }
+            }
+
+            if (local_progress)
+                progress.store(true, std::memory_order_relaxed);
+        });
+
+        if (!progress.load(std::memory_order_relaxed))
+            break;
+
+        for (size_t lane = 0; lane < count; ++lane)
+            if (active.Test(lane) && next[targets[lane]].Test(lane))
+            {
+                distances[lane] = level;
+                active.Reset(lane);
+            }
+
+        std::swap(visit, next);
+    }
+}
+
+template <size_t WORDS>
+static void MultiSourceBatches(ThreadPool& pool, const CsrGraph& incoming, const uint32_t* sources, const uint32_t* targets,
+                               size_t count, uint32_t* distances)
+{
+    constexpr size_t LANES = 64 * WORDS;
+
+    const size_t vertex_count = incoming.VertexCount();
+    auto seen  = unique_ptr<LaneSet<WORDS>[]>(new LaneSet<WORDS>[vertex_count]);
+    auto visit = unique_ptr<LaneSet<WORDS>[]>(new LaneSet<WORDS>[vertex_count]);
+    auto next  = unique_ptr<LaneSet<WORDS>[]>(new LaneSet<WORDS>[vertex_count]);
+
+    for (size_t first = 0; first < count; first += LANES)
+    {
+        size_t batch = std::min(LANES, count - first);
+        MultiSourceBatch<WORDS>(pool, incoming, sources + first, targets + first, batch, distances + first,
+                                seen.get(), visit.get(), next.get());
+    }
+}
+
+void MultiSourceBreadthFirstSearch(const CsrGraph& graph, const CsrGraph& incoming, const uint32_t* sources, const uint32_t* targets,
+                                   size_t count, uint32_t* distances, size_t lanes, ThreadPool& pool)
+{
+    const size_t vertex_count = graph.VertexCount();
+    if (incoming.VertexCount() != vertex_count || incoming.EdgeCount() != graph.EdgeCount())
+        throw std::runtime_error("The incoming edges don't belong to the graph.");
+
+    for (size_t i = 0; i < count; ++i)
+        if (sources[i] >= vertex_count || targets[i] >= vertex_count)
+            throw std::runtime_error("Vertex doesn't exist.");
+
+    if (lanes == 64)
+        MultiSourceBatches<1>(pool, incoming, sources, targets, count, distances);
+    else if (lanes == 256)
+        MultiSourceBatches<4>(pool, incoming, sources, targets, count, distances);
+    else
+        throw std::runtime_error("Multi-source BFS supports 64 or 256 lanes.");
+}
+
+void MultiSourceBreadthFirstSearch(const CsrGraph& graph, const uint32_t* sources, const uint32_t* targets,
+                                   size_t count, uint32_t* distances, size_t lanes, ThreadPool& pool)
+{
+    MultiSourceBreadthFirstSearch(graph, graph, sources, targets, count, distances, lanes, pool);
+}
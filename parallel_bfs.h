@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "graphs.h"
+#include "thread_pool.h"
+
+
+// Direction-optimizing breadth first search (Beamer, Asanović and Patterson, 2012).
+// http://www.scottbeamer.net/pubs/beamer-sc2012.pdf
+//
+// Top-down steps go through the frontier and claim the unvisited neighbours of every vertex in it,
+// which is cheap while the frontier is small. On low-diameter graphs the frontier soon holds a large
+// part of the graph and most of those edges lead to vertices that are already visited. Bottom-up
+// steps instead go through the unvisited vertices and look for any parent in the frontier, and stop
+// at the first one found. The search switches to bottom-up when the frontier has more than 1/ALPHA
+// of the unexplored edges, and back when it has less than 1/BETA of the vertices.
+//
+// The visited set and the bottom-up frontiers are bitmaps, so they fit in cache far longer than a
+// 'bool' per vertex. Each bottom-up task owns whole words of them, so only the top-down claims need
+// atomics. Instead of 'Node' chains, the result is the BFS tree as a parent per vertex.
+constexpr uint32_t BFS_NO_PARENT = UINT32_MAX;
+constexpr size_t   BFS_ALPHA     = 15;
+constexpr size_t   BFS_BETA      = 18;
+constexpr size_t   BFS_GRAIN_SIZE = 1 << 10;   // Frontier vertices, or bitmap words, per task.
+
+// Fills parents[0, VertexCount()) with the parent of every vertex reached from 'source' (the source
+// is its own parent) and BFS_NO_PARENT for the rest. Returns the number of vertices reached.
+// 'incoming' is the transpose of 'graph', which bottom-up steps need; the overload without it is for
+// undirected graphs, where it's the graph itself.
+// Time Complexity: O(V + E), and far fewer edges are looked at in practice.
+// Auxiliary Space: O(V)
+size_t ParallelBreadthFirstSearch(const CsrGraph& graph, const CsrGraph& incoming, uint32_t source, uint32_t* parents,
+                                  ThreadPool& pool = ThreadPool::Global());
+size_t ParallelBreadthFirstSearch(const CsrGraph& graph, uint32_t source, uint32_t* parents,
+                                  ThreadPool& pool = ThreadPool::Global());
+
+
+// https://en.wikipedia.org/wiki/Bidirectional_search
+// Point-to-point BFS that grows a tree from the source along outgoing edges and one from the target
+// along incoming edges, always expanding a whole level of the side whose frontier has fewer edges.
+// On a graph where a BFS fans out by a factor b per level, the two trees meet after visiting about
+// 2 * b^(d/2) vertices instead of b^d. All arrays live in a reusable 'BidirectionalSearchState', which
+// numbers its queries like 'ShortestPathState' so nothing is cleared or allocated per query.
+constexpr uint32_t BFS_UNREACHABLE = UINT32_MAX;
+
+class BidirectionalSearchState
+{
+public:
+    explicit BidirectionalSearchState(size_t vertex_count);
+
+    // The vertices from the source to the target of the last query, or nothing if it wasn't reached.
+    DynamicArray<uint32_t> Path() const;
+
+    size_t VertexCount() const noexcept { return this->vertex_count; }
+
+private:
+    friend uint32_t BidirectionalBreadthFirstSearch(const CsrGraph&, const CsrGraph&, uint32_t, uint32_t, BidirectionalSearchState&);
+
+    struct Side
+    {
+        unique_ptr<uint32_t[]> queries;    // The query that last reached each vertex.
+        unique_ptr<uint32_t[]> distances;
+        unique_ptr<uint32_t[]> parents;
+        unique_ptr<uint32_t[]> queue;
+    };
+
+    Side forward;
+    Side backward;
+    uint32_t query;
+    uint32_t meeting;   // A vertex on the shortest path, or NO_VERTEX.
+    size_t vertex_count;
+};
+
+// Returns the number of edges on a shortest path from 'source' to 'target', or BFS_UNREACHABLE.
+// 'incoming' is the transpose of 'graph', and the overload without it is for undirected graphs.
+// Time Complexity: O(V + E) worst case.
+// Auxiliary Space: O(V), in 'state'.
+uint32_t BidirectionalBreadthFirstSearch(const CsrGraph& graph, const CsrGraph& incoming, uint32_t source, uint32_t target,
+                                         BidirectionalSearchState& state);
+uint32_t BidirectionalBreadthFirstSearch(const CsrGraph& graph, uint32_t source, uint32_t target, BidirectionalSearchState& state);
+
+
+// Multi-source BFS (Then et al., 2014), http://www.vldb.org/pvldb/vol8/p449-then.pdf
+// Answers many point-to-point distance queries with one traversal per batch of 64 or 256 queries.
+// Every vertex has a bit set of the queries ("lanes") that have seen it and of those whose frontier
+// it is in, so the edges that several searches share are only read once per level for all of them.
+// Each level pulls the frontier lanes of every vertex's incoming neighbours, which gives every task
+// its own output vertices and no atomics, and skips vertices that every active query has seen.
+// A query's lane is switched off as soon as its target is reached.
+// Writes the distance from sources[i] to targets[i] (or BFS_UNREACHABLE) to distances[i].
+// Time Complexity: O(D * (V + E)) per batch, for D levels.
+// Auxiliary Space: O(V * lanes / 8) bytes, three bit sets per vertex.
+constexpr size_t MULTI_SOURCE_BFS_DEFAULT_LANES = 256;
+
+void MultiSourceBreadthFirstSearch(const CsrGraph& graph, const CsrGraph& incoming, const uint32_t* sources, const uint32_t* targets,
+                                   size_t count, uint32_t* distances, size_t lanes = MULTI_SOURCE_BFS_DEFAULT_LANES,
+                                   ThreadPool& pool = ThreadPool::Global());
+void MultiSourceBreadthFirstSearch(const CsrGraph& graph, const uint32_t* sources, const uint32_t* targets,
+                                   size_t count, uint32_t* distances, size_t lanes = MULTI_SOURCE_BFS_DEFAULT_LANES,
+                                   ThreadPool& pool = ThreadPool::Global());
@@ -0,0 +1,495 @@
+#include "sorting.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+
+// Benchmark of every sort in sorting.h, and std::sort, over sizes and input distributions.
+// Prints one CSV row or JSON object per run, so results can be diffed between commits.
+//
+//     SortBench [--type int32|int64|float|double] [--min-size N] [--max-size N] [--growth N]
+//               [--repeat N] [--quadratic-limit N] [--no-counts] [--format csv|json] [--output path]
+//               [--seed N] [--only name]
+
+
+// ---- Instrumented element ----
+static std::atomic<uint64_t> comparison_count { 0 };
+static std::atomic<uint64_t> swap_count       { 0 };
+static std::atomic<uint64_t> move_count       { 0 };
+
+// Counts comparisons, swaps and copies. Only used in a separate run from the timed one, as the counters
+// are shared between threads.
+template <class T>
+struct Counted
+{
+    T value;
+
+    Counted() = default;
+    Counted(T value) : value(value) {}
+    Counted(const Counted<T>& other) : value(other.value) { move_count.fetch_add(1, std::memory_order_relaxed); }
+    Counted<T>& operator= (const Counted<T>& other)
+    {
+        move_count.fetch_add(1, std::memory_order_relaxed);
+        this->value = other.value;
+        return *this;
+    }
+
+    static bool Count(bool result) { comparison_count.fetch_add(1, std::memory_order_relaxed); return result; }
+
+    friend bool operator<  (const Counted<T>& a, const Counted<T>& b) { return Count(a.value <  b.value); }
+    friend bool operator>  (const Counted<T>& a, const Counted<T>& b) { return Count(a.value >  b.value); }
+    friend bool operator<= (const Counted<T>& a, const Counted<T>& b) { return Count(a.value <= b.value); }
+    friend bool operator>= (const Counted<T>& a, const Counted<T>& b) { return Count(a.value >= b.value); }
+    friend bool operator== (const Counted<T>& a, const Counted<T>& b) { return Count(a.value == b.value); }
+    friend bool operator!= (const Counted<T>& a, const Counted<T>& b) { return Count(a.value != b.value); }
+};
+
+// Found through argument-dependent lookup from the sorts, and preferred over the generic 'Swap'.
+template <class T>
+void Swap(Counted<T>* a, Counted<T>* b)
+{
+    swap_count.fetch_add(1, std::memory_order_relaxed);
+
+    Counted<T> temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+
+// ---- Input distributions ----
+enum class Distribution { UNIFORM, SORTED, REVERSED, FEW_UNIQUE, ORGAN_PIPE, ZIPF };
+
+static const char* DISTRIBUTION_NAMES[] = { "uniform", "sorted", "reversed", "few_unique", "organ_pipe", "zipf" };
+
+constexpr size_t FEW_UNIQUE_COUNT = 16;
+constexpr size_t ZIPF_MAX_RANK    = 1 << 20;
+constexpr double ZIPF_EXPONENT    = 1.0;
+
+// All values are non-negative, which 'BucketSort' needs.
+template <class T>
+T UniformValue(std::mt19937_64& random)
+{
+    if constexpr (std::is_floating_point_v<T>)
+        return T(std::uniform_real_distribution<double>(0.0, 1.0)(random));
+    else
+        return T(random() >> (65 - 8 * sizeof(T)));
+}
+
+template <class T>
+void Generate(T* array, size_t count, Distribution distribution, std::mt19937_64& random)
+{
+    switch (distribution)
+    {
+        case Distribution::UNIFORM:
+            for (size_t i = 0; i < count; ++i)
+                array[i] = UniformValue<T>(random);
+            break;
+        case Distribution::SORTED:
+            for (size_t i = 0; i < count; ++i)
+                array[i] = T(i);
+            break;
+        case Distribution::REVERSED:
+            for (size_t i = 0; i < count; ++i)
+                array[i] = T(count - i);
+            break;
+        case Distribution::FEW_UNIQUE:
+            for (size_t i = 0; i < count; ++i)
+                array[i] = T(random() % FEW_UNIQUE_COUNT);
+            break;
+        case Distribution::ORGAN_PIPE:
+            for (size_t i = 0; i < count; ++i)
+                array[i] = T(i < count / 2 ? i : count - i);
+            break;
+        case Distribution::ZIPF:
+        {
+            // Inverse transform sampling over the cumulative distribution of the ranks.
+            size_t rank_count = std::max<size_t>(std::min(count, ZIPF_MAX_RANK), 1);
+            std::vector<double> cumulative(rank_count);
+
+            double total = 0.0;
+            for (size_t k = 0; k < rank_count; ++k)
+                cumulative[k] = (total += 1.0 / std::pow(double(k + 1), ZIPF_EXPONENT));
+
+            std::uniform_real_distribution<double> uniform(0.0, total);
+            for (size_t i = 0; i < count; ++i)
+                array[i] = T(std::lower_bound(cumulative.begin(), cumulative.end(), uniform(random)) - cumulative.begin());
+            break;
+        }
+    }
+}
+
+// Order independent fingerprint of the values, to check that a sort didn't lose or invent any.
+template <class T>
+uint64_t Fingerprint(const T* array, size_t count)
+{
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint64_t bits = 0;
+        memcpy(&bits, &array[i], sizeof(T));
+
+        // splitmix64 finalizer, so that different multisets don't cancel out.
+        bits += 0x9E3779B97F4A7C15ull;
+        bits  = (bits ^ (bits >> 30)) * 0xBF58476D1CE4E5B9ull;
+        bits  = (bits ^ (bits >> 27)) * 0x94D049BB133111EBull;
+        sum  += bits ^ (bits >> 31);
+    }
+    return sum;
+}
+
+
+// ---- Algorithms ----
+enum class Complexity
+{
+    N_LOG_N,
+    QUADRATIC,             // Skipped above the quadratic limit.
+    QUADRATIC_ON_PATTERNS, // Skipped above the quadratic limit unless the input is uniform.
+    NARROW_RANGE,          // Skipped when the range of values is much larger than the count, or for floats.
+};
+
+template <class T>
+struct SortAlgorithm
+{
+    const char* name;
+    Complexity  complexity;
+    void (*sort)(T* array, size_t count);
+    void (*counted_sort)(Counted<T>* array, size_t count);  // nullptr for sorts that don't compare elements.
+};
+
+static std::string temporary_directory = std::filesystem::temp_directory_path().string();
+
+// Round trip through a file, so the timing includes writing the input and reading the result back.
+template <class T>
+void ExternalSortInMemory(T* array, size_t count)
+{
+    const std::string input_path  = temporary_directory + "/sort_bench_input.bin";
+    const std::string output_path = temporary_directory + "/sort_bench_output.bin";
+
+    FILE* input = fopen(input_path.c_str(), "wb");
+    if (input == nullptr)
+        throw std::runtime_error("Couldn't open " + input_path + " for writing.");
+
+    bool written = fwrite(array, sizeof(T), count, input) == count;
+    if (fclose(input) != 0 || !written)
+        throw std::runtime_error("Couldn't write " + input_path);
+
+    ExternalSort<T>(input_path.c_str(), output_path.c_str(), std::max<size_t>(count * sizeof(T) / 4, 1 << 20), temporary_directory.c_str());
+
+    FILE* output = fopen(output_path.c_str(), "rb");
+    if (output == nullptr)
+        throw std::runtime_error("Couldn't open " + output_path + " for reading.");
+
+    bool read = fread(array, sizeof(T), count, output) == count;
+    fclose(output);
+    if (!read)
+        throw std::runtime_error("External sort lost elements.");
+
+    std::remove(input_path.c_str());
+    std::remove(output_path.c_str());
+}
+
+#define COMPARISON_SORT(name, complexity, call) \
+    SortAlgorithm<T> { name, complexity, [](T* array, size_t count) { call; }, [](Counted<T>* array, size_t count) { call; } }
+#define COUNTING_SORT(name, complexity, call) \
+    SortAlgorithm<T> { name, complexity, [](T* array, size_t count) { call; }, nullptr }
+
+template <class T>
+std::vector<SortAlgorithm<T>> Algorithms()
+{
+    return {
+        COMPARISON_SORT("InsertionSort",     Complexity::QUADRATIC,             InsertionSort(array, count)),
+        COMPARISON_SORT("BubbleSort",        Complexity::QUADRATIC,             BubbleSort(array, count)),
+        COMPARISON_SORT("SelectionSort",     Complexity::QUADRATIC,             SelectionSort(array, count)),
+        COMPARISON_SORT("MergeSort",         Complexity::N_LOG_N,               MergeSort(array, count)),
+        COMPARISON_SORT("NaturalMergeSort",  Complexity::N_LOG_N,               NaturalMergeSort(array, count)),
+        COMPARISON_SORT("QuickSort",         Complexity::QUADRATIC_ON_PATTERNS, QuickSort(array, count)),
+        COMPARISON_SORT("HeapSort",          Complexity::N_LOG_N,               HeapSort(array, count)),
+        COMPARISON_SORT("IntroSort",         Complexity::N_LOG_N,               IntroSort(array, count)),
+        COMPARISON_SORT("ShellSort",         Complexity::N_LOG_N,               ShellSort(array, count)),
+        COMPARISON_SORT("ParallelMergeSort", Complexity::N_LOG_N,               ParallelMergeSort(array, count)),
+        // Keep N_LOG_N: organ_pipe is what catches a ParallelQuickSort without a depth limit.
+        COMPARISON_SORT("ParallelQuickSort", Complexity::N_LOG_N,               ParallelQuickSort(array, count)),
+        COMPARISON_SORT("std::sort",         Complexity::N_LOG_N,               std::sort(array, array + count)),
+        COUNTING_SORT("CountingSort",        Complexity::NARROW_RANGE,          if constexpr (std::is_integral_v<T>) CountingSort(array, count)),
+        COUNTING_SORT("RadixSort",           Complexity::N_LOG_N,               RadixSort(array, count)),
+        COUNTING_SORT("BucketSort",          Complexity::N_LOG_N,               BucketSort(array, count, std::max<size_t>(count / 4, 1))),
+        COUNTING_SORT("ExternalSort",        Complexity::N_LOG_N,               ExternalSortInMemory(array, count)),
+    };
+}
+
+#undef COMPARISON_SORT
+#undef COUNTING_SORT
+
+
+// ---- Driver ----
+struct Options
+{
+    std::string type   = "int32";
+    std::string format = "csv";
+    std::string output;
+    std::string only;
+    size_t min_size  = 16;
+    size_t max_size  = 1 << 20;
+    size_t growth    = 4;
+    size_t repeat    = 3;
+    size_t quadratic_limit = 1 << 14;
+    bool   counts    = true;
+    uint64_t seed    = 42;
+};
+
+struct Result
+{
+    const char*  algorithm;
+    const char*  type;
+    Distribution distribution;
+    size_t       size;
+    double       ns_per_element;
+    bool         has_counts;
+    uint64_t     comparisons;
+    uint64_t     swaps;
+    uint64_t     moves;
+    bool         sorted;
+};
+
+class ResultWriter
+{
+public:
+    ResultWriter(FILE* file, bool json) : file(file), json(json), first(true)
+    {
+        if (this->json)
+            fprintf(this->file, "[\n");
+        else
+            fprintf(this->file, "algorithm,type,distribution,size,ns_per_element,comparisons,swaps,moves,sorted\n");
+    }
+    ~ResultWriter()
+    {
+        if (this->json)
+            fprintf(this->file, "\n]\n");
+    }
+
+    void Write(const Result& result)
+    {
+        char counts[96] = ",,";
+        if (result.has_counts)
+            snprintf(counts, sizeof(counts), "%llu,%llu,%llu", (unsigned long long) result.comparisons, (unsigned long long) result.swaps, (unsigned long long) result.moves);
+
+        if (this->json)
+        {
+            char comparisons[32] = "null", swaps[32] = "null", moves[32] = "null";
+            if (result.has_counts)
+            {
+                snprintf(comparisons, sizeof(comparisons), "%llu", (unsigned long long) result.comparisons);
+                snprintf(swaps,       sizeof(swaps),       "%llu", (unsigned long long) result.swaps);
+                snprintf(moves,       sizeof(moves),       "%llu", (unsigned long long) result.moves);
+            }
+
+            fprintf(this->file,
+                    "%s  {\"algorithm\": \"%s\", \"type\": \"%s\", \"distribution\": \"%s\", \"size\": %zu, "
+                    "\"ns_per_element\": %.3f, \"comparisons\": %s, \"swaps\": %s, \"moves\": %s, \"sorted\": %s}",
+                    this->first ? "" : ",\n", result.algorithm, result.type, DISTRIBUTION_NAMES[size_t(result.distribution)],
+                    result.size, result.ns_per_element, comparisons, swaps, moves, result.sorted ? "true" : "false");
+        }
+        else
+        {
+            fprintf(this->file, "%s,%s,%s,%zu,%.3f,%s,%s\n",
+                    result.algorithm, result.type, DISTRIBUTION_NAMES[size_t(result.distribution)], result.size,
+                    result.ns_per_element, counts, result.sorted ? "true" : "false");
+        }
+
+        this->first = false;
+        fflush(this->file);
+    }
+
+private:
+    FILE* file;
+    bool  json;
+    bool  first;
+};
+
+template <class T>
+bool ShouldRun(const SortAlgorithm<T>& algorithm, const T* input, size_t count, Distribution distribution, const Options& options)
+{
+    if (!options.only.empty() && options.only != algorithm.name)
+        return false;
+
+    switch (algorithm.complexity)
+    {
+        case Complexity::N_LOG_N:
+            return true;
+        case Complexity::QUADRATIC:
+            return count <= options.quadratic_limit;
+        case Complexity::QUADRATIC_ON_PATTERNS:
+            return count <= options.quadratic_limit || distribution == Distribution::UNIFORM;
+        case Complexity::NARROW_RANGE:
+        {
+            if (!std::is_integral_v<T> || count == 0)
+                return false;
+            const auto [minimum, maximum] = MinMax(input, count);
+            return double(maximum) - double(minimum) <= 4.0 * double(count) + 65536.0;
+        }
+    }
+
+    return false;
+}
+
+template <class T>
+void Run(const Options& options, ResultWriter& writer)
+{
+    using Clock = std::chrono::steady_clock;
+
+    const auto algorithms = Algorithms<T>();
+    std::mt19937_64 random(options.seed);
+
+    for (size_t size = options.min_size; size <= options.max_size; size = (size * options.growth > size) ? size * options.growth : options.max_size + 1)
+    {
+        auto input   = unique_ptr<T[]>(new T[size]);
+        auto working = unique_ptr<T[]>(new T[size]);
+
+        for (size_t d = 0; d < ARRAY_SIZE(DISTRIBUTION_NAMES); ++d)
+        {
+            const auto distribution = Distribution(d);
+
+            Generate(input.get(), size, distribution, random);
+            const uint64_t fingerprint = Fingerprint(input.get(), size);
+
+            for (const auto& algorithm : algorithms)
+            {
+                if (!ShouldRun(algorithm, input.get(), size, distribution, options))
+                    continue;
+
+                std::vector<double> times;
+                for (size_t r = 0; r < std::max<size_t>(options.repeat, 1); ++r)
+                {
+                    Copy(working.get(), size, input.get(), size);
+
+                    auto start = Clock::now();
+                    algorithm.sort(working.get(), size);
+                    times.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+                }
+                std::sort(times.begin(), times.end());
+
+                Result result = {};
+                result.algorithm      = algorithm.name;
+                result.type           = options.type.c_str();
+                result.distribution   = distribution;
+                result.size           = size;
+                result.ns_per_element = times[times.size() / 2] / double(std::max<size_t>(size, 1));
+                result.sorted         = std::is_sorted(working.get(), working.get() + size) && Fingerprint(working.get(), size) == fingerprint;
+
+                if (options.counts && algorithm.counted_sort != nullptr)
+                {
+                    auto counted = unique_ptr<Counted<T>[]>(new Counted<T>[size]);
+                    for (size_t i = 0; i < size; ++i)
+                        counted[i].value = input[i];
+
+                    comparison_count = 0;
+                    swap_count       = 0;
+                    move_count       = 0;
+
+                    algorithm.counted_sort(counted.get(), size);
+
+                    result.has_counts  = true;
+                    result.comparisons = comparison_count;
+                    result.swaps       = swap_count;
+                    result.moves       = move_count;
+                }
+
+                writer.Write(result);
+            }
+        }
+    }
+}
+
+static void PrintUsage()
+{
+    fprintf(stderr,
+            "Usage: SortBench [options]\n"
+            "  --type int32|int64|float|double  Element type (default int32).\n"
+            "  --min-size N                     Smallest input (default 16).\n"
+            "  --max-size N                     Largest input, up to 1000000000 (default 1048576).\n"
+            "  --growth N                       Factor between sizes (default 4).\n"
+            "  --repeat N                       Timed runs per case; the median is reported (default 3).\n"
+            "  --quadratic-limit N              Largest input for O(n^2) sorts (default 16384).\n"
+            "  --no-counts                      Skip the instrumented run counting comparisons, swaps and moves.\n"
+            "  --format csv|json                Output format (default csv).\n"
+            "  --output path                    Write to a file instead of stdout.\n"
+            "  --temporary-directory path       Where ExternalSort puts its files.\n"
+            "  --only name                      Run a single algorithm, e.g. IntroSort or std::sort.\n"
+            "  --seed N                         Seed for the input generator (default 42).\n");
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+
+    // 'std::stoull' throws 'std::invalid_argument' or 'std::out_of_range' for a bad number.
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string argument = argv[i];
+            const bool has_value = i + 1 < argc;
+
+            if      (argument == "--type"            && has_value) options.type   = argv[++i];
+            else if (argument == "--format"          && has_value) options.format = argv[++i];
+            else if (argument == "--output"          && has_value) options.output = argv[++i];
+            else if (argument == "--only"            && has_value) options.only   = argv[++i];
+            else if (argument == "--temporary-directory" && has_value) temporary_directory = argv[++i];
+            else if (argument == "--min-size"        && has_value) options.min_size = std::stoull(argv[++i]);
+            else if (argument == "--max-size"        && has_value) options.max_size = std::stoull(argv[++i]);
+            else if (argument == "--growth"          && has_value) options.growth   = std::stoull(argv[++i]);
+            else if (argument == "--repeat"          && has_value) options.repeat   = std::stoull(argv[++i]);
+            else if (argument == "--quadratic-limit" && has_value) options.quadratic_limit = std::stoull(argv[++i]);
+            else if (argument == "--seed"            && has_value) options.seed     = std::stoull(argv[++i]);
+            else if (argument == "--no-counts") options.counts = false;
+            else
+            {
+                PrintUsage();
+                return argument == "--help" ? 0 : 1;
+            }
+        }
+    }
+    catch (const std::logic_error&)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    if (options.growth < 2 || options.min_size == 0 || (options.format != "csv" && options.format != "json") ||
+        (options.type != "int32" && options.type != "int64" && options.type != "float" && options.type != "double"))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    FILE* file = options.output.empty() ? stdout : fopen(options.output.c_str(), "w");
+    if (file == nullptr)
+    {
+        fprintf(stderr, "Couldn't open '%s'.\n", options.output.c_str());
+        return 1;
+    }
+
+    int status = 0;
+    try
+    {
+        ResultWriter writer(file, options.format == "json");
+
+        if      (options.type == "int32")  Run<int32_t>(options, writer);
+        else if (options.type == "int64")  Run<int64_t>(options, writer);
+        else if (options.type == "float")  Run<float>(options, writer);
+        else if (options.type == "double") Run<double>(options, writer);
+    }
+    catch (const std::runtime_error& error)
+    {
+        // E.g. a '--temporary-directory' that doesn't exist or isn't writable.
+        fprintf(stderr, "%s\n", error.what());
+        status = 1;
+    }
+
+    if (file != stdout)
+        fclose(file);
+    return status;
+}
@@ -0,0 +1,1903 @@
+#pragma once
+
+#include <new>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "utilities.h"
+#include "thread_pool.h"
+#include "sorting_network.h"
+#include "data_structures/heap.h"
+#include "data_structures/dynamic_array.h"
+
+
+// Time Complexity: O(n*2)
+// Auxiliary Space: O(1)
+// Boundary Cases: Insertion sort takes maximum time to sort if elements are sorted in reverse order. And it takes minimum time (Order of n) when elements are already sorted.
+// Sorting In Place: Yes
+// Stable: Yes
+// Online: Yes
+template <class T>
+void InsertionSort(T* array, size_t count)
+{
+    if (count <= 1)
+        return;
+
+    for (size_t i = 1; i < count; ++i)
+    {
+        T element = array[i];
+
+        size_t j = i;
+        while (j > 0 && element < array[j - 1])  // NOTE(ted): Beware of underflow.
+        {
+            array[j] = array[j - 1];
+            --j;
+        }
+
+        array[j] = element;
+    }
+}
+
+// Sorts small ranges of int32_t and float with a SIMD sorting network. Returns false for other types,
+// sizes outside [SORTING_NETWORK_MIN_COUNT, SORTING_NETWORK_MAX_COUNT], or CPUs without SSE4.1.
+template <class T>
+bool SortingNetworkLeaf(T* array, size_t count)
+{
+    if constexpr (std::is_same_v<T, int32_t> || std::is_same_v<T, float>)
+        return SORTING_NETWORK_MIN_COUNT <= count && count <= SORTING_NETWORK_MAX_COUNT && SortingNetworkSort(array, count);
+    else
+        return false;
+}
+
+
+
+// Worst and Average Case Time Complexity: O(n*n). Worst case occurs when array is reverse sorted.
+// Best Case Time Complexity: O(n). Best case occurs when array is already sorted.
+// Boundary Cases: Bubble sort takes minimum time (Order of n) when elements are already sorted.
+// Auxiliary Space: O(1)
+// Sorting In Place: Yes
+// Stable: Yes
+template <class T>
+void BubbleSort(T* array, size_t count)
+{
+    if (count <= 1)
+        return;
+
+    bool swapped = false;
+
+    for (size_t i = 0; i < count - 1; ++i)
+    {
+        for (size_t j = 0; j < count - i - 1; ++j)
+        {
+            if (array[j] > array[j + 1])
+            {
+                Swap(&array[j], &array[j + 1]);
+                swapped = true;
+            }
+        }
+
+        if (!swapped)
+            return;
+    }
+}
+
+
+// Time Complexity: O(n2) as there are two nested loops.
+// Auxiliary Space: O(1). The good thing about selection sort is it never makes more than O(n) swaps and can be useful when memory write is a costly operation.
+// Stable: No, but can be made.
+// Sorting In Place: Yes.
+template <class T>
+void SelectionSort(T* array, size_t count)
+{
+    if (count <= 1)
+        return;
+
+    for (size_t i = 0; i < count - 1; ++i)
+    {
+        size_t index_of_min = i;
+
+        for (size_t j = i; j < count; ++j)
+            if (array[j] < array[index_of_min])
+                index_of_min = j;
+
+        Swap(&array[i], &array[index_of_min]);
+    }
+}
+
+
+// https://www.geeksforgeeks.org/merge-sort/
+// Time Complexity: Sorting arrays on different machines. Merge Sort is a recursive algorithm and time complexity can be expressed as following recurrence relation.
+// T(n) = 2T(n/2) + \Theta(n)
+// The above recurrence can be solved either using Recurrence Tree method or Master method. It falls in case II of Master Method and solution of the recurrence is \Theta(nLogn).
+// Time complexity of Merge Sort is \Theta(nLogn) in all 3 cases (worst, average and best) as merge sort always divides the array into two halves and take linear time to merge two halves.
+// Auxiliary Space: O(n)
+// Algorithmic Paradigm: Divide and Conquer
+// Sorting In Place: No in a typical implementation
+// Stable: Yes
+template <class T>
+void Merge(T* array, size_t left, size_t middle, size_t right, T* storage)
+{
+    size_t left_count  = middle - left;
+    size_t right_count = right - middle;
+
+    T* left_array  = storage + left;
+    T* right_array = storage + middle;
+
+    Copy(left_array,  left_count,  array + left,   right);
+    Copy(right_array, right_count, array + middle, right);
+
+    size_t i = left;
+    size_t left_i  = 0;
+    size_t right_i = 0;
+
+    while (left_i < left_count && right_i < right_count)
+    {
+        if (left_array[left_i] <= right_array[right_i])
+            array[i++] = left_array[left_i++];
+        else
+            array[i++] = right_array[right_i++];
+    }
+
+    while (left_i < left_count)
+        array[i++] = left_array[left_i++];
+    while (right_i < right_count)
+        array[i++] = right_array[right_i++];
+}
+template <class T>
+void MergeSortHelper(T* array, size_t left, size_t right, T* result)
+{
+    if (SortingNetworkLeaf(array + left, right - left))
+        return;
+
+    if (left + 1 < right)
+    {
+        size_t middle = (left + right) / 2;    // (l+r) / 2  = l + (r-l) / 2;
+
+        MergeSortHelper(array, left,   middle, result);
+        MergeSortHelper(array, middle, right,  result);
+
+        Merge(array, left, middle, right, result);
+    }
+}
+template <class T>
+void MergeSort(T* array, size_t count)
+{
+    T* result = new T[count];
+    MergeSortHelper(array, 0, count, result);
+    delete[] result;
+}
+
+
+// Bottom-up merge sort over the runs already in the input (https://en.wikipedia.org/wiki/Timsort).
+// Descending runs are reversed and short runs are extended to NATURAL_MERGE_MIN_RUN elements with
+// insertion sort. Then every pass merges neighbouring runs from one buffer into the other, so nothing
+// is copied back until the end, and the scratch space comes from the caller. When one run keeps winning
+// the merge, it switches to galloping: an exponential search for how many elements to copy in one go.
+// Time Complexity: O(n log r) for r runs, so O(n) for sorted, reverse sorted and nearly sorted input.
+// Auxiliary Space: O(1), plus the caller's scratch buffer of 'count' elements.
+// Sorting In Place: No
+// Stable: Yes
+constexpr size_t NATURAL_MERGE_MIN_RUN    = 32;
+constexpr size_t NATURAL_MERGE_MIN_GALLOP = 7;
+
+// Scratch space that only grows, so repeated sorts of similar sizes don't allocate.
+template <class T>
+class ScratchBuffer
+{
+public:
+    ScratchBuffer() : data(nullptr), capacity(0) {}
+
+    T* Reserve(size_t count)
+    {
+        if (count > this->capacity)
+        {
+            this->data     = unique_ptr<T[]>(new T[count]);
+            this->capacity = count;
+        }
+
+        return this->data.get();
+    }
+
+    [[nodiscard]] size_t Capacity() const noexcept { return this->capacity; }
+
+private:
+    unique_ptr<T[]> data;
+    size_t capacity;
+};
+
+// Index of the first element greater than 'key' (like std::upper_bound), searching from the front in
+// steps of 1, 2, 4... so it's cheap when the answer is close to the front.
+template <class T>
+size_t GallopUpperBound(const T* array, size_t count, const T& key)
+{
+    size_t low  = 0;
+    size_t step = 1;
+    while (step <= count && !(key < array[step - 1]))
+    {
+        low   = step;
+        step *= 2;
+    }
+
+    return std::upper_bound(array + low, array + std::min(step, count), key) - array;
+}
+// Index of the first element not less than 'key' (like std::lower_bound), searching from the front.
+template <class T>
+size_t GallopLowerBound(const T* array, size_t count, const T& key)
+{
+    size_t low  = 0;
+    size_t step = 1;
+    while (step <= count && array[step - 1] < key)
+    {
+        low   = step;
+        step *= 2;
+    }
+
+    return std::lower_bound(array + low, array + std::min(step, count), key) - array;
+}
+
+template <class T>
+void GallopingMerge(const T* a, size_t a_count, const T* b, size_t b_count, T* output)
+{
+    size_t i = 0;
+    size_t j = 0;
+    size_t k = 0;
+
+    // Runs that are already in order are just concatenated.
+    if (a_count != 0 && b_count != 0 && b[0] < a[a_count - 1])
+    {
+        size_t a_wins = 0;
+        size_t b_wins = 0;
+
+        while (i < a_count && j < b_count)
+        {
+            if (b[j] < a[i])
+            {
+                output[k++] = b[j++];
+                ++b_wins;
+                a_wins = 0;
+            }
+            else
+            {
+                output[k++] = a[i++];
+                ++a_wins;
+                b_wins = 0;
+            }
+
+            if (i == a_count || j == b_count)
+                break;
+
+            if (a_wins >= NATURAL_MERGE_MIN_GALLOP)
+            {
+                size_t n = GallopUpperBound(a + i, a_count - i, b[j]);
+                Copy(output + k, n, a + i, n);
+                i += n;
+                k += n;
+                a_wins = 0;
+            }
+            else if (b_wins >= NATURAL_MERGE_MIN_GALLOP)
+            {
+                size_t n = GallopLowerBound(b + j, b_count - j, a[i]);
+                Copy(output + k, n, b + j, n);
+                j += n;
+                k += n;
+                b_wins = 0;
+            }
+        }
+    }
+
+    Copy(output + k, a_count - i, a + i, a_count - i);
+    k += a_count - i;
+    Copy(output + k, b_count - j, b + j, b_count - j);
+}
+
+// End of the non-descending run that starts at 'begin'.
+template <class T>
+size_t FindRunEnd(const T* array, size_t begin, size_t count)
+{
+    size_t end = begin + 1;
+    while (end < count && !(array[end] < array[end - 1]))
+        ++end;
+    return end;
+}
+
+template <class T>
+void NaturalMergeSort(T* array, size_t count, T* scratch)
+{
+    if (count <= 1)
+        return;
+
+    // Make every run ascending and at least NATURAL_MERGE_MIN_RUN elements long. Only strictly
+    // descending runs are reversed, so equal elements keep their order.
+    for (size_t begin = 0; begin < count; )
+    {
+        size_t end = begin + 1;
+        if (end < count && array[end] < array[begin])
+        {
+            while (end < count && array[end] < array[end - 1])
+                ++end;
+            Reverse(array + begin, end - begin);
+        }
+        else
+        {
+            end = FindRunEnd(array, begin, count);
+        }
+
+        if (end - begin < NATURAL_MERGE_MIN_RUN)
+        {
+            end = std::min(begin + NATURAL_MERGE_MIN_RUN, count);
+            InsertionSort(array + begin, end - begin);
+        }
+
+        begin = end;
+    }
+
+    T* source      = array;
+    T* destination = scratch;
+
+    while (FindRunEnd(source, 0, count) != count)
+    {
+        for (size_t begin = 0; begin < count; )
+        {
+            size_t middle = FindRunEnd(source, begin, count);
+            size_t end    = (middle < count) ? FindRunEnd(source, middle, count) : count;
+
+            GallopingMerge(source + begin, middle - begin, source + middle, end - middle, destination + begin);
+            begin = end;
+        }
+
+        Swap(&source, &destination);
+    }
+
+    if (source != array)
+        Copy(array, count, source, count);
+}
+template <class T>
+void NaturalMergeSort(T* array, size_t count, ScratchBuffer<T>& scratch)
+{
+    NaturalMergeSort(array, count, scratch.Reserve(count));
+}
+template <class T>
+void NaturalMergeSort(T* array, size_t count)
+{
+    ScratchBuffer<T> scratch;
+    NaturalMergeSort(array, count, scratch);
+}
+
+
+// https://www.geeksforgeeks.org/quick-sort/
+// Best Case Time Complexity: \theta(n Log n). The best case occurs when the partition process always picks the middle element as pivot. T(n) = 2T(n/2) + \theta(n).
+// Average Case Time Complexity: O(n Log n). T(n) = T(n/9) + T(9n/10) + \theta(n)
+// Worst Case Time Complexity: O(n2)
+// Auxiliary Space: O(1)
+// Sorting In Place: No, extra space is needed for the recursion.
+// Stable: No
+template <class T>
+const T& MedianOfThree(const T& a, const T& b, const T& c)
+{
+    if (a < b)
+        return (b < c) ? b : (a < c) ? c : a;
+    else
+        return (a < c) ? a : (b < c) ? c : b;
+}
+template <class T>
+size_t Partition(T* array, size_t left, size_t right)
+{
+    T pivot = array[right-1];
+
+    size_t i = left;
+    for (size_t j = left; j < right; j++)
+        if (array[j] < pivot)
+            Swap(&array[i++], &array[j]);
+
+    Swap(&array[i], &array[right-1]);
+    return i;
+}
+template <class T>
+void QuickSortHelper(T* array, size_t left, size_t right)
+{
+    if (SortingNetworkLeaf(array + left, right - left))
+        return;
+
+    if (left + 1 < right)
+    {
+        size_t pivot_index = Partition(array, left, right);
+
+        QuickSortHelper(array, left, pivot_index);
+        QuickSortHelper(array, pivot_index + 1, right);
+    }
+}
+template <class T>
+void QuickSort(T* array, size_t count)
+{
+    QuickSortHelper(array, 0, count);
+}
+
+
+// Time Complexity: Time complexity of heapify is O(Log n). Time complexity of BuildMaxHeap() is O(n). The overall time complexity of Heap Sort is O(n Log n).
+// Auxiliary Space: O(1)
+// Sorting In Place: No, extra space is needed for the recursion.
+// Stable: No
+// Heap sort algorithm has limited uses because Quicksort and Mergesort are better in practice.
+template <class T>
+void HeapSort(T* array, size_t count)
+{
+    if (count <= 1)
+        return;
+
+    BuildMaxHeap(array, count);
+
+    for (size_t i = count; i--; )  // NOTE(ted): Beware of underflow.
+    {
+        Swap(&array[0], &array[i]);
+        Heapify(array, i, 0);
+    }
+}
+
+
+// Pattern-defeating introsort (https://arxiv.org/abs/2106.05123): quick sort with insertion sort for
+// small ranges and heap sort as a fallback when too many partitions end up unbalanced.
+// Pivots are the median of three, or Tukey's ninther for large ranges. The partition goes through
+// blocks of elements, collecting the offsets of misplaced elements without branches before swapping
+// them. If the element before a range equals the chosen pivot, the range is instead partitioned into
+// '<= pivot' and '> pivot', so the run of equal elements is finished in one pass.
+// Time Complexity: O(n log n) worst case, O(n) for sorted, reverse sorted and all-equal input.
+// Auxiliary Space: O(log n)
+// Sorting In Place: Yes
+// Stable: No
+constexpr size_t INTRO_SORT_INSERTION_THRESHOLD = 24;
+constexpr size_t INTRO_SORT_NINTHER_THRESHOLD   = 128;
+constexpr size_t INTRO_SORT_BLOCK_SIZE          = 64;
+constexpr size_t INTRO_SORT_PARTIAL_INSERTION_LIMIT = 8;
+
+template <class T>
+void SortThree(T* array, size_t a, size_t b, size_t c)
+{
+    if (array[b] < array[a]) Swap(&array[a], &array[b]);
+    if (array[c] < array[b]) Swap(&array[b], &array[c]);
+    if (array[b] < array[a]) Swap(&array[a], &array[b]);
+}
+
+// Insertion sort that gives up after moving 'INTRO_SORT_PARTIAL_INSERTION_LIMIT' elements.
+// Returns whether the range ended up sorted.
+template <class T>
+bool PartialInsertionSort(T* array, size_t left, size_t right)
+{
+    size_t moved = 0;
+
+    for (size_t i = left + 1; i < right; ++i)
+    {
+        if (!(array[i] < array[i - 1]))
+            continue;
+
+        T element = array[i];
+
+        size_t j = i;
+        while (j > left && element < array[j - 1])
+        {
+            array[j] = array[j - 1];
+            --j;
+        }
+
+        array[j] = element;
+
+        moved += i - j;
+        if (moved > INTRO_SORT_PARTIAL_INSERTION_LIMIT)
+            return false;
+    }
+
+    return true;
+}
+
+// Partitions [left, right) around the pivot at array[left] into '< pivot' and '>= pivot'.
+// Returns the final position of the pivot and whether the range was already partitioned.
+template <class T>
+std::pair<size_t, bool> PartitionRight(T* array, size_t left, size_t right)
+{
+    const T pivot = array[left];
+
+    size_t l = left + 1;
+    size_t r = right;
+    bool swapped = false;
+
+    unsigned char offsets_l[INTRO_SORT_BLOCK_SIZE];
+    unsigned char offsets_r[INTRO_SORT_BLOCK_SIZE];
+    size_t start_l = 0, count_l = 0;
+    size_t start_r = 0, count_r = 0;
+
+    // Elements left of 'l' are known to be less than the pivot and elements from 'r' on are known to be
+    // greater or equal. A block is only retired once all of its misplaced elements have been swapped.
+    while (r - l >= 2 * INTRO_SORT_BLOCK_SIZE)
+    {
+        if (count_l == 0)
+        {
+            start_l = 0;
+            for (size_t i = 0; i < INTRO_SORT_BLOCK_SIZE; ++i)
+            {
+                offsets_l[count_l] = (unsigned char) i;
+                count_l += !(array[l + i] < pivot);
+            }
+        }
+
+        if (count_r == 0)
+        {
+            start_r = 0;
+            for (size_t i = 0; i < INTRO_SORT_BLOCK_SIZE; ++i)
+            {
+                offsets_r[count_r] = (unsigned char) i;
+                count_r += (array[r - 1 - i] < pivot);
+            }
+        }
+
+        size_t count = std::min(count_l, count_r);
+        for (size_t i = 0; i < count; ++i)
+            Swap(&array[l + offsets_l[start_l + i]], &array[r - 1 - offsets_r[start_r + i]]);
+
+        swapped |= (count != 0);
+
+        count_l -= count; start_l += count;
+        count_r -= count; start_r += count;
+
+        if (count_l == 0) l += INTRO_SORT_BLOCK_SIZE;
+        if (count_r == 0) r -= INTRO_SORT_BLOCK_SIZE;
+    }
+
+    // The rest, including any block with misplaced elements left, is less than three blocks.
+    while (true)
+    {
+        while (l < r && array[l] < pivot)
+            ++l;
+        while (l < r && !(array[r - 1] < pivot))
+            --r;
+
+        if (l >= r)
+            break;
+
+        Swap(&array[l++], &array[--r]);
+        swapped = true;
+    }
+
+    Swap(&array[left], &array[l - 1]);
+    return { l - 1, !swapped };
+}
+
+// Partitions [left, right) around the pivot at array[left] into '<= pivot' and '> pivot'.
+// Returns the final position of the pivot.
+template <class T>
+size_t PartitionLeft(T* array, size_t left, size_t right)
+{
+    const T pivot = array[left];
+
+    size_t l = left + 1;
+    size_t r = right;
+
+    while (true)
+    {
+        while (l < r && !(pivot < array[l]))
+            ++l;
+        while (l < r && pivot < array[r - 1])
+            --r;
+
+        if (l >= r)
+            break;
+
+        Swap(&array[l++], &array[--r]);
+    }
+
+    Swap(&array[left], &array[l - 1]);
+    return l - 1;
+}
+
+// Moves the median of three, or Tukey's ninther for large ranges, to array[left].
+template <class T>
+void ChoosePivot(T* array, size_t left, size_t right)
+{
+    size_t size   = right - left;
+    size_t middle = left + size / 2;
+
+    if (size > INTRO_SORT_NINTHER_THRESHOLD)
+    {
+        SortThree(array, left,     middle,     right - 1);
+        SortThree(array, left + 1, middle - 1, right - 2);
+        SortThree(array, left + 2, middle + 1, right - 3);
+        SortThree(array, middle - 1, middle, middle + 1);
+        Swap(&array[left], &array[middle]);
+    }
+    else
+    {
+        SortThree(array, middle, left, right - 1);
+    }
+}
+
+template <class T>
+void IntroSortHelper(T* array, size_t left, size_t right, size_t bad_partitions_allowed, bool leftmost)
+{
+    while (true)
+    {
+        size_t size = right - left;
+
+        if (SortingNetworkLeaf(array + left, size))
+            return;
+
+        if (size < INTRO_SORT_INSERTION_THRESHOLD)
+        {
+            InsertionSort(array + left, size);
+            return;
+        }
+
+        ChoosePivot(array, left, right);
+
+        // Everything in this range is >= array[left - 1], so if the pivot is equal to it there can't be
+        // anything less than the pivot, and all elements equal to the pivot are in their final place.
+        if (!leftmost && !(array[left - 1] < array[left]))
+        {
+            left = PartitionLeft(array, left, right) + 1;
+            continue;
+        }
+
+        const auto [pivot_index, already_partitioned] = PartitionRight(array, left, right);
+
+        size_t left_size  = pivot_index - left;
+        size_t right_size = right - (pivot_index + 1);
+
+        if (left_size < size / 8 || right_size < size / 8)
+        {
+            if (--bad_partitions_allowed == 0)
+            {
+                HeapSort(array + left, size);
+                return;
+            }
+
+            // Break up patterns that keep producing bad pivots.
+            if (left_size >= INTRO_SORT_INSERTION_THRESHOLD)
+            {
+                Swap(&array[left], &array[left + left_size / 4]);
+                Swap(&array[pivot_index - 1], &array[pivot_index - left_size / 4]);
+            }
+            if (right_size >= INTRO_SORT_INSERTION_THRESHOLD)
+            {
+                Swap(&array[pivot_index + 1], &array[pivot_index + 1 + right_size / 4]);
+                Swap(&array[right - 1], &array[right - right_size / 4]);
+            }
+        }
+        else if (already_partitioned &&
+                 PartialInsertionSort(array, left, pivot_index) &&
+                 PartialInsertionSort(array, pivot_index + 1, right))
+        {
+            return;
+        }
+
+        // Recurse into the smaller side and loop on the larger, so the stack stays O(log n).
+        if (left_size < right_size)
+        {
+            IntroSortHelper(array, left, pivot_index, bad_partitions_allowed, leftmost);
+            left     = pivot_index + 1;
+            leftmost = false;
+        }
+        else
+        {
+            IntroSortHelper(array, pivot_index + 1, right, bad_partitions_allowed, false);
+            right = pivot_index;
+        }
+    }
+}
+template <class T>
+void IntroSort(T* array, size_t count)
+{
+    if (count <= 1)
+        return;
+
+    IntroSortHelper(array, 0, count, Log2(count), true);
+}
+
+
+// https://en.wikipedia.org/wiki/Shellsort
+// Time Complexity: O(n^2) worst case, around O(n^1.3) in practice with these gaps.
+// Auxiliary Space: O(1)
+// Sorting In Place: Yes
+// Stable: No
+//
+// Ciura's gaps, which were found experimentally, extended with h_k = 2.25 * h_{k-1} for larger arrays.
+constexpr size_t SHELL_SORT_GAPS[] = { 1, 4, 10, 23, 57, 132, 301, 701 };
+
+template <class T>
+void ShellSort(T* array, size_t count)
+{
+    size_t gaps[64];
+    size_t gap_count = 0;
+
+    for (size_t gap : SHELL_SORT_GAPS)
+        gaps[gap_count++] = gap;
+    while (gaps[gap_count - 1] * 9 / 4 < count)
+    {
+        gaps[gap_count] = gaps[gap_count - 1] * 9 / 4;
+        ++gap_count;
+    }
+
+    for (size_t g = gap_count; g-- > 0; )
+    {
+        size_t gap = gaps[g];
+
+        for (size_t i = gap; i < count; ++i)
+        {
+            T element = array[i];
+
+            size_t j = i;
+            while (j >= gap && array[j - gap] > element)
+            {
+                array[j] = array[j - gap];
+                j -= gap;
+            }
+
+            array[j] = element;
+        }
+    }
+}
+
+
+// Time Complexity: O(n + k), where k is the range of the values.
+// Auxiliary Space: O(n + k)
+// Sorting In Place: No
+// Stable: Yes
+// Only use it when k is small compared to n; a single outlier makes k, and the memory, huge. 'RadixSort' has no such problem.
+template <class T>
+void CountingSort(T* array, size_t count)
+{
+    if (count <= 1)
+        return;
+
+    const auto& [minimum, maximum] = MinMax(array, count);
+
+    // Going through size_t makes the difference wrap around correctly for signed types.
+    size_t k = size_t(maximum) - size_t(minimum) + 1;
+
+    auto counter = make_unique<size_t[]>(k);
+
+    auto input = unique_ptr<T[]>(new T[count]);
+    Copy(input.get(), count, array, count);
+
+    for (size_t i = 0; i < count; ++i)
+        counter[size_t(input[i]) - size_t(minimum)] += 1;
+
+    ExclusivePrefixSum(counter.get(), k);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t x = size_t(input[i]) - size_t(minimum);
+        array[counter[x]] = input[i];
+        counter[x] += 1;
+    }
+}
+
+
+// https://en.wikipedia.org/wiki/Radix_sort
+// Sorts by fixed-width unsigned keys, one digit at a time, with a counting sort per digit.
+// Time Complexity: O(w/d * (n + 2^d)) for w-bit keys and d-bit digits.
+// Auxiliary Space: O(n + 2^d)
+// Sorting In Place: No
+// Stable: Yes
+//
+// 32-bit keys are sorted least significant digit first with 8, 11 or 16-bit digits, ping-ponging between
+// the array and one buffer. All digit histograms are built in a single read of the input, and a pass is
+// skipped when every key has the same digit (e.g. the high bytes of small values).
+// Wider keys are sorted most significant digit first, which stops recursing once a bucket gets small, so
+// random 64-bit keys need a couple of passes instead of eight.
+constexpr size_t RADIX_SORT_MSD_DIGIT_BITS = 8;
+constexpr size_t RADIX_SORT_MSD_THRESHOLD  = 64;   // MSD buckets smaller than this are insertion sorted.
+constexpr size_t RADIX_SORT_SMALL_COUNT    = 1 << 16;
+
+// Maps 32/64-bit integers and IEEE floats to unsigned integers with the same order. Negative floats
+// have all bits flipped, as larger magnitudes are smaller, and everything else gets the sign bit flipped.
+template <class T>
+auto ToRadixKey(T value)
+{
+    static_assert(std::is_arithmetic_v<T> && (sizeof(T) == 4 || sizeof(T) == 8), "Radix keys must be 32 or 64-bit integers or floats.");
+
+    using Key = std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>;
+    constexpr Key SIGN_BIT = Key(1) << (8 * sizeof(Key) - 1);
+
+    if constexpr (std::is_floating_point_v<T>)
+    {
+        Key bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return (bits & SIGN_BIT) ? Key(~bits) : Key(bits | SIGN_BIT);
+    }
+    else if constexpr (std::is_signed_v<T>)
+    {
+        return Key(Key(value) ^ SIGN_BIT);
+    }
+    else
+    {
+        return Key(value);
+    }
+}
+
+template <class T, class GetKey>
+void RadixInsertionSort(T* array, size_t count, GetKey& get_key)
+{
+    for (size_t i = 1; i < count; ++i)
+    {
+        T element = array[i];
+        auto key  = get_key(element);
+
+        size_t j = i;
+        while (j > 0 && key < get_key(array[j - 1]))
+        {
+            array[j] = array[j - 1];
+            --j;
+        }
+
+        array[j] = element;
+    }
+}
+
+template <class T, class GetKey>
+void LsdRadixSort(T* array, size_t count, T* buffer, GetKey& get_key, size_t digit_bits)
+{
+    using Key = decltype(get_key(array[0]));
+
+    const size_t pass_count = (8 * sizeof(Key) + digit_bits - 1) / digit_bits;
+    const size_t radix      = size_t(1) << digit_bits;
+    const Key    mask       = Key(radix - 1);
+
+    auto counters = make_unique<size_t[]>(pass_count * radix);
+    for (size_t i = 0; i < count; ++i)
+    {
+        Key key = get_key(array[i]);
+        for (size_t pass = 0; pass < pass_count; ++pass)
+            ++counters[pass * radix + ((key >> (pass * digit_bits)) & mask)];
+    }
+
+    T* source      = array;
+    T* destination = buffer;
+
+    for (size_t pass = 0; pass < pass_count; ++pass)
+    {
+        size_t  shift   = pass * digit_bits;
+        size_t* counter = counters.get() + pass * radix;
+
+        if (counter[(get_key(source[0]) >> shift) & mask] == count)
+            continue;
+
+        ExclusivePrefixSum(counter, radix);
+
+        for (size_t i = 0; i < count; ++i)
+            destination[counter[(get_key(source[i]) >> shift) & mask]++] = source[i];
+
+        Swap(&source, &destination);
+    }
+
+    if (source != array)
+        Copy(array, count, source, count);
+}
+
+template <class T, class GetKey>
+void MsdRadixSortHelper(T* array, T* buffer, size_t count, size_t shift, GetKey& get_key)
+{
+    constexpr size_t RADIX = size_t(1) << RADIX_SORT_MSD_DIGIT_BITS;
+    constexpr size_t MASK  = RADIX - 1;
+
+    if (count < RADIX_SORT_MSD_THRESHOLD)
+    {
+        RadixInsertionSort(array, count, get_key);
+        return;
+    }
+
+    size_t counter[RADIX] = {};
+    for (size_t i = 0; i < count; ++i)
+        ++counter[(get_key(array[i]) >> shift) & MASK];
+
+    size_t bucket_sizes[RADIX];
+    Copy(bucket_sizes, RADIX, counter, RADIX);
+
+    if (counter[(get_key(array[0]) >> shift) & MASK] != count)
+    {
+        ExclusivePrefixSum(counter, RADIX);
+
+        for (size_t i = 0; i < count; ++i)
+            buffer[counter[(get_key(array[i]) >> shift) & MASK]++] = array[i];
+
+        Copy(array, count, buffer, count);
+    }
+
+    if (shift == 0)
+        return;
+
+    size_t start = 0;
+    for (size_t bucket = 0; bucket < RADIX; ++bucket)
+    {
+        if (bucket_sizes[bucket] > 1)
+            MsdRadixSortHelper(array + start, buffer + start, bucket_sizes[bucket], shift - RADIX_SORT_MSD_DIGIT_BITS, get_key);
+        start += bucket_sizes[bucket];
+    }
+}
+
+// Sorts by 'get_key(element)', which must return uint32_t or uint64_t. 'digit_bits' can force an LSD
+// sort with 8, 11 or 16-bit digits; 0 picks the digit size and direction from the key width and count.
+template <class T, class GetKey>
+void RadixSortBy(T* array, size_t count, GetKey get_key, size_t digit_bits = 0)
+{
+    using Key = decltype(get_key(array[0]));
+    static_assert(std::is_unsigned_v<Key> && (sizeof(Key) == 4 || sizeof(Key) == 8), "Radix keys must be uint32_t or uint64_t.");
+
+    if (digit_bits != 0 && digit_bits != 8 && digit_bits != 11 && digit_bits != 16)
+        throw std::runtime_error("Radix digits must be 8, 11 or 16 bits.");
+
+    if (count <= 1)
+        return;
+
+    auto buffer = unique_ptr<T[]>(new T[count]);
+
+    if (digit_bits == 0 && sizeof(Key) > 4)
+        MsdRadixSortHelper(array, buffer.get(), count, 8 * sizeof(Key) - RADIX_SORT_MSD_DIGIT_BITS, get_key);
+    else if (digit_bits == 0)
+        LsdRadixSort(array, count, buffer.get(), get_key, count < RADIX_SORT_SMALL_COUNT ? 8 : 11);
+    else
+        LsdRadixSort(array, count, buffer.get(), get_key, digit_bits);
+}
+template <class T>
+void RadixSort(T* array, size_t count, size_t digit_bits = 0)
+{
+    RadixSortBy(array, count, ToRadixKey<T>, digit_bits);
+}
+
+
+template <class T>
+void BucketSort(T* array, size_t count, size_t bucket_count)
+{
+    if (count <= 1 || bucket_count == 0)
+        return;
+
+    auto buckets = make_unique<DynamicArray<T>[]>(bucket_count);
+
+    auto maximum = Max(array, count);
+
+    // Adding a small amount so that 'GetBucketIndex' doesn't return index = bucket_count. For large
+    // maximums the float rounds the amount away, so the index is clamped as well.
+    const float divisor = float(maximum) + 0.0001f;
+    const auto GetBucketIndex = [&divisor](T element, size_t bucket_count) { return std::min(size_t((element / divisor) * bucket_count), bucket_count - 1); };
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t bucket_index = GetBucketIndex(array[i], bucket_count);
+
+        DynamicArray<T>& bucket = buckets[bucket_index];
+        bucket.Add(&array[i], 1);
+    }
+
+    for (size_t i = 0; i < bucket_count; ++i)
+    {
+        DynamicArray<T>& bucket = buckets[i];
+        if (!SortingNetworkLeaf(bucket.Raw(), bucket.Count()))
+            InsertionSort(bucket.Raw(), bucket.Count());
+    }
+
+    size_t index = 0;
+    for (size_t i = 0; i < bucket_count; ++i)
+    {
+        DynamicArray<T>& bucket = buckets[i];
+        for (size_t j = 0; j < bucket.Count(); ++j)
+            array[index++] = bucket[j];
+    }
+}
+
+
+// Multithreaded versions of merge sort and quick sort. The recursion is forked into tasks on a
+// work-stealing pool, and ranges of at most 'grain_size' elements are sorted by the serial code.
+constexpr size_t PARALLEL_SORT_GRAIN_SIZE = 1 << 14;
+
+// Merges the sorted ranges 'a' and 'b' into 'output'. The larger range is split at its middle and
+// the split point is binary searched in the other, so the two halves can be merged independently.
+// Equal elements are taken from 'a' first, which keeps the merge stable.
+template <class T>
+void ParallelMerge(ThreadPool& pool, const T* a, size_t a_count, const T* b, size_t b_count, T* output, size_t grain_size)
+{
+    if (a_count + b_count <= std::max<size_t>(grain_size, 2))
+    {
+        size_t i = 0;
+        size_t a_i = 0;
+        size_t b_i = 0;
+
+        while (a_i < a_count && b_i < b_count)
+        {
+            if (b[b_i] < a[a_i])
+                output[i++] = b[b_i++];
+            else
+                output[i++] = a[a_i++];
+        }
+
+        while (a_i < a_count)
+            output[i++] = a[a_i++];
+        while (b_i < b_count)
+            output[i++] = b[b_i++];
+
+        return;
+    }
+
+    size_t a_middle;
+    size_t b_middle;
+
+    if (a_count >= b_count)
+    {
+        a_middle = a_count / 2;
+        b_middle = std::lower_bound(b, b + b_count, a[a_middle]) - b;
+    }
+    else
+    {
+        b_middle = b_count / 2;
+        a_middle = std::upper_bound(a, a + a_count, b[b_middle]) - a;
+    }
+
+    TaskGroup group(pool);
+    group.Run([&] { ParallelMerge(pool, a, a_middle, b, b_middle, output, grain_size); });
+    ParallelMerge(pool, a + a_middle, a_count - a_middle, b + b_middle, b_count - b_middle, output + a_middle + b_middle, grain_size);
+    group.Wait();
+}
+template <class T>
+void ParallelMergeSortHelper(ThreadPool& pool, T* array, size_t left, size_t right, T* storage, size_t grain_size)
+{
+    if (right - left <= grain_size)
+    {
+        MergeSortHelper(array, left, right, storage);
+        return;
+    }
+
+    size_t middle = (left + right) / 2;
+
+    TaskGroup group(pool);
+    group.Run([&] { ParallelMergeSortHelper(pool, array, left, middle, storage, grain_size); });
+    ParallelMergeSortHelper(pool, array, middle, right, storage, grain_size);
+    group.Wait();
+
+    ParallelFor(pool, left, right, grain_size, [&](size_t begin, size_t end) {
+        Copy(storage + begin, end - begin, array + begin, end - begin);
+    });
+    ParallelMerge(pool, storage + left, middle - left, storage + middle, right - middle, array + left, grain_size);
+}
+template <class T>
+void ParallelMergeSort(T* array, size_t count, size_t grain_size = PARALLEL_SORT_GRAIN_SIZE, ThreadPool& pool = ThreadPool::Global())
+{
+    if (count <= 1)
+        return;
+
+    auto storage = unique_ptr<T[]>(new T[count]);
+    ParallelMergeSortHelper(pool, array, 0, count, storage.get(), std::max<size_t>(grain_size, 1));
+}
+
+
+// Every level is partitioned in parallel around a ninther pivot: each block of 'grain_size'
+// elements counts how many of its elements are less than, equal to and greater than the pivot,
+// and after a prefix sum the blocks scatter into 'storage' and copy back. The elements equal to
+// the pivot are in their final place, so duplicates never get recursed on. The smaller side is
+// spawned and the larger one looped on, and once 'depth_allowed' levels are used up (e.g. on
+// organ-pipe input) the rest of the range is left to 'IntroSort', so the work stays O(n log n).
+template <class T>
+T ParallelQuickSortPivot(const T* array, size_t left, size_t right)
+{
+    size_t size   = right - left;
+    size_t step   = size / 8;
+    size_t middle = left + size / 2;
+
+    return MedianOfThree(
+        MedianOfThree(array[left],          array[left + step],   array[left + 2 * step]),
+        MedianOfThree(array[middle - step], array[middle],        array[middle + step]),
+        MedianOfThree(array[right - 1 - 2 * step], array[right - 1 - step], array[right - 1])
+    );
+}
+template <class T>
+std::pair<size_t, size_t> ParallelQuickSortPartition(ThreadPool& pool, T* array, size_t left, size_t right, T* storage, size_t grain_size)
+{
+    const T pivot = ParallelQuickSortPivot(array, left, right);
+
+    size_t block_count = (right - left + grain_size - 1) / grain_size;
+    auto counts = make_unique<size_t[]>(3 * block_count);
+
+    ParallelFor(pool, 0, block_count, 1, [&](size_t first_block, size_t last_block) {
+        for (size_t block = first_block; block < last_block; ++block)
+        {
+            size_t begin = left + block * grain_size;
+            size_t end   = std::min(begin + grain_size, right);
+
+            size_t less    = 0;
+            size_t greater = 0;
+            for (size_t i = begin; i < end; ++i)
+            {
+                less    += (array[i] < pivot);
+                greater += (pivot < array[i]);
+            }
+
+            counts[3 * block + 0] = less;
+            counts[3 * block + 1] = (end - begin) - less - greater;
+            counts[3 * block + 2] = greater;
+        }
+    });
+
+    // Exclusive prefix sum, turning the counts into each block's write offsets.
+    size_t totals[3] = { 0, 0, 0 };
+    for (size_t block = 0; block < block_count; ++block)
+        for (size_t k = 0; k < 3; ++k)
+        {
+            size_t count = counts[3 * block + k];
+            counts[3 * block + k] = totals[k];
+            totals[k] += count;
+        }
+
+    size_t equal_begin   = left + totals[0];
+    size_t greater_begin = equal_begin + totals[1];
+
+    ParallelFor(pool, 0, block_count, 1, [&](size_t first_block, size_t last_block) {
+        for (size_t block = first_block; block < last_block; ++block)
+        {
+            size_t begin = left + block * grain_size;
+            size_t end   = std::min(begin + grain_size, right);
+
+            T* less    = storage + left          + counts[3 * block + 0];
+            T* equal   = storage + equal_begin   + counts[3 * block + 1];
+            T* greater = storage + greater_begin + counts[3 * block + 2];
+
+            for (size_t i = begin; i < end; ++i)
+            {
+                if (array[i] < pivot)
+                    *less++ = array[i];
+                else if (pivot < array[i])
+                    *greater++ = array[i];
+                else
+                    *equal++ = array[i];
+            }
+        }
+    });
+
+    ParallelFor(pool, left, right, grain_size, [&](size_t begin, size_t end) {
+        Copy(array + begin, end - begin, storage + begin, end - begin);
+    });
+
+    return { equal_begin, greater_begin };
+}
+template <class T>
+void ParallelQuickSortHelper(ThreadPool& pool, T* array, size_t left, size_t right, T* storage, size_t grain_size, size_t depth_allowed)
+{
+    TaskGroup group(pool);
+
+    while (true)
+    {
+        if (right - left <= grain_size || depth_allowed == 0)
+        {
+            IntroSort(array + left, right - left);
+            break;
+        }
+        --depth_allowed;
+
+        const auto [equal_begin, greater_begin] = ParallelQuickSortPartition(pool, array, left, right, storage, grain_size);
+
+        // Spawn the smaller side and loop on the larger, so the stack stays O(log n).
+        if (equal_begin - left < right - greater_begin)
+        {
+            size_t end = equal_begin;
+            group.Run([=, &pool] { ParallelQuickSortHelper(pool, array, left, end, storage, grain_size, depth_allowed); });
+            left = greater_begin;
+        }
+        else
+        {
+            size_t begin = greater_begin;
+            group.Run([=, &pool] { ParallelQuickSortHelper(pool, array, begin, right, storage, grain_size, depth_allowed); });
+            right = equal_begin;
+        }
+    }
+
+    group.Wait();
+}
+template <class T>
+void ParallelQuickSort(T* array, size_t count, size_t grain_size = PARALLEL_SORT_GRAIN_SIZE, ThreadPool& pool = ThreadPool::Global())
+{
+    if (count <= 1)
+        return;
+
+    auto storage = unique_ptr<T[]>(new T[count]);
+    ParallelQuickSortHelper(pool, array, 0, count, storage.get(), std::max<size_t>(grain_size, 1), 2 * Log2(count));
+}
+
+
+// https://en.wikipedia.org/wiki/External_sorting
+// Sorts a binary file of T that doesn't fit in memory, using at most 'memory_budget' bytes of buffers.
+// The input is read in chunks of half the budget, so the next chunk is read while the current one is
+// sorted and written out as a temporary run. The runs are then k-way merged through a heap. Every run
+// and the output stream through two blocks, one being filled while the other is read or written.
+// When there are too many runs for blocks of at least EXTERNAL_SORT_MIN_BLOCK_SIZE bytes, the runs are
+// merged in several passes.
+// Time Complexity: O(n log n), with O(n log_k(n/M)) bytes of sequential I/O for memory M and fan-in k.
+// Auxiliary Space: 'memory_budget' bytes of memory, and the size of the input in temporary files.
+// Stable: No
+constexpr size_t EXTERNAL_SORT_MIN_BLOCK_SIZE = 1 << 20;
+
+// Reads a file of T sequentially, with the next block read in the background.
+template <class T>
+class BlockReader
+{
+public:
+    BlockReader(const char* path, size_t block_count) :
+        file(fopen(path, "rb")), block_count(block_count), current(new T[block_count]), next(new T[block_count]), count(0), position(0), done(false)
+    {
+        if (this->file == nullptr)
+            throw std::runtime_error("Couldn't open file for reading.");
+
+        this->Prefetch();
+        this->Advance();
+    }
+    ~BlockReader()
+    {
+        if (this->pending.valid())
+            this->pending.wait();
+        fclose(this->file);
+    }
+
+    [[nodiscard]] bool IsEmpty() const noexcept { return this->position == this->count; }
+
+    T Next()
+    {
+        T value = this->current[this->position++];
+        if (this->position == this->count && !this->done)
+            this->Advance();
+        return value;
+    }
+
+private:
+    void Prefetch()
+    {
+        this->pending = std::async(std::launch::async, [this]
+        {
+            size_t read = fread(this->next.get(), sizeof(T), this->block_count, this->file);
+            if (read != this->block_count && ferror(this->file))
+                throw std::runtime_error("Couldn't read file.");
+            return read;
+        });
+    }
+
+    void Advance()
+    {
+        this->count    = this->pending.get();
+        this->position = 0;
+        std::swap(this->current, this->next);
+
+        if (this->count == this->block_count)
+            this->Prefetch();
+        else
+            this->done = true;
+    }
+
+    FILE* file;
+    size_t block_count;
+    unique_ptr<T[]> current;
+    unique_ptr<T[]> next;
+    size_t count;
+    size_t position;
+    bool done;
+    std::future<size_t> pending;
+};
+
+// Writes a file of T sequentially, with the previous block written in the background.
+template <class T>
+class BlockWriter
+{
+public:
+    BlockWriter(const char* path, size_t block_count) :
+        file(fopen(path, "wb")), block_count(block_count), current(new T[block_count]), next(new T[block_count]), count(0)
+    {
+        if (this->file == nullptr)
+            throw std::runtime_error("Couldn't open file for writing.");
+    }
+    ~BlockWriter()
+    {
+        if (this->pending.valid())
+            this->pending.wait();
+        fclose(this->file);
+    }
+
+    void Add(const T& value)
+    {
+        this->current[this->count++] = value;
+        if (this->count == this->block_count)
+            this->Flush();
+    }
+
+    void Close()
+    {
+        if (this->count != 0)
+            this->Flush();
+        if (this->pending.valid())
+            this->pending.get();
+    }
+
+private:
+    void Flush()
+    {
+        if (this->pending.valid())
+            this->pending.get();
+
+        std::swap(this->current, this->next);
+
+        size_t write_count = this->count;
+        this->count = 0;
+
+        this->pending = std::async(std::launch::async, [this, write_count]
+        {
+            if (fwrite(this->next.get(), sizeof(T), write_count, this->file) != write_count)
+                throw std::runtime_error("Couldn't write file.");
+        });
+    }
+
+    FILE* file;
+    size_t block_count;
+    unique_ptr<T[]> current;
+    unique_ptr<T[]> next;
+    size_t count;
+    std::future<void> pending;
+};
+
+// Heap entry for the k-way merge. 'MaxHeap' pops the largest entry, so the order is reversed.
+template <class T>
+struct ExternalMergeEntry
+{
+    T      value;
+    size_t run;
+
+    ExternalMergeEntry() = default;
+    ExternalMergeEntry(T value, size_t run) : value(value), run(run) {}
+
+    bool operator< (const ExternalMergeEntry<T>& other) const { return other.value < this->value; }
+    bool operator> (const ExternalMergeEntry<T>& other) const { return this->value < other.value; }
+};
+
+template <class T>
+void MergeRuns(const std::vector<std::string>& runs, size_t first, size_t last, const std::string& output_path, size_t block_count)
+{
+    size_t run_count = last - first;
+
+    std::vector<unique_ptr<BlockReader<T>>> readers;
+    readers.reserve(run_count);
+    for (size_t i = first; i < last; ++i)
+        readers.push_back(make_unique<BlockReader<T>>(runs[i].c_str(), block_count));
+
+    MaxHeap<ExternalMergeEntry<T>> heap(run_count);
+    for (size_t i = 0; i < run_count; ++i)
+        if (!readers[i]->IsEmpty())
+            heap.Add(readers[i]->Next(), i);
+
+    BlockWriter<T> writer(output_path.c_str(), block_count);
+    while (heap.Count() != 0)
+    {
+        const ExternalMergeEntry<T>& entry = heap.Top();
+        writer.Add(entry.value);
+
+        BlockReader<T>& reader = *readers[entry.run];
+        if (!reader.IsEmpty())
+            heap.ReplaceTop(ExternalMergeEntry<T>(reader.Next(), entry.run));
+        else
+            heap.Pop(0);
+    }
+    writer.Close();
+
+    readers.clear();
+    for (size_t i = first; i < last; ++i)
+        std::remove(runs[i].c_str());
+}
+
+template <class T>
+void ExternalSort(const char* input_path, const char* output_path, size_t memory_budget, const char* temporary_directory = ".")
+{
+    static_assert(std::is_trivially_copyable_v<T>, "External sort reads and writes the raw bytes of T.");
+
+    namespace fs = std::filesystem;
+
+    const std::string run_prefix = (fs::path(temporary_directory) / fs::path(output_path).filename()).string();
+    const auto RunPath = [&run_prefix](size_t pass, size_t index)
+    {
+        return run_prefix + "." + std::to_string(pass) + "." + std::to_string(index) + ".run";
+    };
+
+    // ---- Run generation: sort one chunk while the next is read. ----
+    const size_t chunk_count = std::max<size_t>(memory_budget / (2 * sizeof(T)), 1);
+
+    std::vector<std::string> runs;
+    {
+        FILE* input = fopen(input_path, "rb");
+        if (input == nullptr)
+            throw std::runtime_error("Couldn't open file for reading.");
+
+        auto current = unique_ptr<T[]>(new T[chunk_count]);
+        auto next    = unique_ptr<T[]>(new T[chunk_count]);
+
+        const auto ReadChunk = [input, chunk_count](T* chunk) { return fread(chunk, sizeof(T), chunk_count, input); };
+
+        size_t count = ReadChunk(current.get());
+        while (count != 0)
+        {
+            auto pending = std::async(std::launch::async, ReadChunk, next.get());
+
+            IntroSort(current.get(), count);
+
+            // A single run is already the result.
+            bool only_run = runs.empty() && count < chunk_count;
+            runs.push_back(only_run ? std::string(output_path) : RunPath(0, runs.size()));
+
+            FILE* run = fopen(runs.back().c_str(), "wb");
+            bool written = run != nullptr && fwrite(current.get(), sizeof(T), count, run) == count;
+            if (run != nullptr)
+                fclose(run);
+
+            count = pending.get();
+            if (!written || ferror(input))
+            {
+                fclose(input);
+                throw std::runtime_error("Couldn't write run.");
+            }
+
+            std::swap(current, next);
+        }
+
+        fclose(input);
+    }
+
+    if (runs.empty())
+    {
+        FILE* output = fopen(output_path, "wb");
+        if (output == nullptr)
+            throw std::runtime_error("Couldn't open file for writing.");
+        fclose(output);
+        return;
+    }
+    if (runs.size() == 1 && runs[0] == output_path)
+        return;
+
+    // ---- Merge passes: every input run and the output get two blocks each. ----
+    const size_t max_fan_in = std::max<size_t>(memory_budget / (2 * EXTERNAL_SORT_MIN_BLOCK_SIZE), 3) - 1;
+
+    for (size_t pass = 1; ; ++pass)
+    {
+        if (runs.size() <= max_fan_in)
+        {
+            size_t block_count = std::max<size_t>(memory_budget / ((2 * runs.size() + 2) * sizeof(T)), 1);
+            MergeRuns<T>(runs, 0, runs.size(), output_path, block_count);
+            return;
+        }
+
+        size_t block_count = std::max<size_t>(memory_budget / ((2 * max_fan_in + 2) * sizeof(T)), 1);
+
+        std::vector<std::string> merged;
+        for (size_t first = 0; first < runs.size(); first += max_fan_in)
+        {
+            size_t last = std::min(first + max_fan_in, runs.size());
+            merged.push_back(RunPath(pass, merged.size()));
+            MergeRuns<T>(runs, first, last, merged.back(), block_count);
+        }
+
+        runs = std::move(merged);
+    }
+}
+
+
+// Indirect sorting for wide records or columnar data. Only (key, index) pairs move during the sort,
+// and the values are permuted once at the end.
+// ArgSort: O(n) with 'RadixSort' for 32/64-bit arithmetic keys, O(n log n) with 'IntroSort' otherwise.
+// Stable: Yes, ties are broken by the original index.
+constexpr size_t PERMUTATION_BLOCK_BYTES = 1 << 18;   // About the size of L2.
+
+template <class K>
+struct KeyIndex
+{
+    K      key;
+    size_t index;
+
+    bool operator< (const KeyIndex<K>& other) const { return this->key < other.key || (!(other.key < this->key) && this->index < other.index); }
+    bool operator> (const KeyIndex<K>& other) const { return other < *this; }
+};
+
+template <class K>
+unique_ptr<KeyIndex<K>[]> SortedKeyIndices(const K* keys, size_t count)
+{
+    auto pairs = unique_ptr<KeyIndex<K>[]>(new KeyIndex<K>[count]);
+    for (size_t i = 0; i < count; ++i)
+        pairs[i] = { keys[i], i };
+
+    if constexpr (std::is_arithmetic_v<K> && (sizeof(K) == 4 || sizeof(K) == 8))
+        RadixSortBy(pairs.get(), count, [](const KeyIndex<K>& pair) { return ToRadixKey(pair.key); });
+    else
+        IntroSort(pairs.get(), count);
+
+    return pairs;
+}
+
+// Writes the permutation that sorts 'keys' to 'indices', so keys[indices[0]] is the smallest key.
+template <class K>
+void ArgSort(const K* keys, size_t count, size_t* indices)
+{
+    auto pairs = SortedKeyIndices(keys, count);
+    for (size_t i = 0; i < count; ++i)
+        indices[i] = pairs[i].index;
+}
+
+// destination[i] = source[permutation[i]]. Large inputs are gathered one cache-sized block of 'source'
+// at a time: the (destination, source) index pairs are first bucketed by source block with a counting
+// pass, so the random reads stay in cache and only the writes, which don't stall, are scattered.
+template <class T>
+void ApplyPermutation(const T* source, const size_t* permutation, size_t count, T* destination)
+{
+    const size_t block_count = (count * sizeof(T) + PERMUTATION_BLOCK_BYTES - 1) / PERMUTATION_BLOCK_BYTES;
+
+    if (block_count <= 4)
+    {
+        for (size_t i = 0; i < count; ++i)
+            destination[i] = source[permutation[i]];
+        return;
+    }
+
+    const size_t block_size = (count + block_count - 1) / block_count;
+
+    auto counter = make_unique<size_t[]>(block_count);
+    for (size_t i = 0; i < count; ++i)
+        ++counter[permutation[i] / block_size];
+
+    ExclusivePrefixSum(counter.get(), block_count);
+
+    auto moves = unique_ptr<std::pair<size_t, size_t>[]>(new std::pair<size_t, size_t>[count]);
+    for (size_t i = 0; i < count; ++i)
+        moves[counter[permutation[i] / block_size]++] = { i, permutation[i] };
+
+    for (size_t i = 0; i < count; ++i)
+        destination[moves[i].first] = source[moves[i].second];
+}
+
+// values[i] = old values[permutation[i]], in place, by following the cycles of the permutation.
+// Needs one bit per element.
+template <class T>
+void ApplyPermutation(T* values, const size_t* permutation, size_t count)
+{
+    std::vector<bool> placed(count);
+
+    for (size_t start = 0; start < count; ++start)
+    {
+        if (placed[start])
+            continue;
+
+        T first = values[start];
+
+        size_t i = start;
+        while (permutation[i] != start)
+        {
+            values[i] = values[permutation[i]];
+            placed[i] = true;
+            i = permutation[i];
+        }
+
+        values[i] = first;
+        placed[i] = true;
+    }
+}
+
+// Sorts 'keys' and reorders every column in 'values' the same way.
+template <class K, class ... V>
+void SortByKey(K* keys, size_t count, V* ... values)
+{
+    auto pairs = SortedKeyIndices(keys, count);
+
+    auto permutation = unique_ptr<size_t[]>(new size_t[count]);
+    for (size_t i = 0; i < count; ++i)
+    {
+        keys[i]        = pairs[i].key;
+        permutation[i] = pairs[i].index;
+    }
+    pairs.reset();
+
+    (ApplyPermutation(values, permutation.get(), count), ...);
+}
+
+
+// https://en.wikipedia.org/wiki/Introselect
+// Quick select with the pivots and partitioning of 'IntroSort': only the side containing 'nth' is
+// partitioned further. Falls back to sorting the range after too many unbalanced partitions.
+// Afterwards array[nth] is the element a full sort would put there, with nothing greater before it and
+// nothing less after it.
+// Time Complexity: O(n) average, O(n log n) worst case.
+// Auxiliary Space: O(1)
+template <class T>
+void NthElement(T* array, size_t count, size_t nth)
+{
+    if (nth >= count)
+        return;
+
+    size_t left  = 0;
+    size_t right = count;
+    size_t bad_partitions_allowed = Log2(count);
+    bool leftmost = true;
+
+    while (right - left >= INTRO_SORT_INSERTION_THRESHOLD)
+    {
+        size_t size = right - left;
+
+        ChoosePivot(array, left, right);
+
+        // See 'IntroSortHelper': [left, pivot_index] are all equal to array[left - 1].
+        if (!leftmost && !(array[left - 1] < array[left]))
+        {
+            size_t pivot_index = PartitionLeft(array, left, right);
+            if (nth <= pivot_index)
+                return;
+
+            left = pivot_index + 1;
+            continue;
+        }
+
+        size_t pivot_index = PartitionRight(array, left, right).first;
+
+        if (nth == pivot_index)
+            return;
+
+        size_t left_size  = pivot_index - left;
+        size_t right_size = right - (pivot_index + 1);
+        if ((left_size < size / 8 || right_size < size / 8) && --bad_partitions_allowed == 0)
+        {
+            IntroSort(array + left, size);
+            return;
+        }
+
+        if (nth < pivot_index)
+        {
+            right = pivot_index;
+        }
+        else
+        {
+            left     = pivot_index + 1;
+            leftmost = false;
+        }
+    }
+
+    InsertionSort(array + left, right - left);
+}
+
+// Sorts the 'k' smallest elements into array[0, k). The order of the rest is unspecified.
+// Time Complexity: O(n + k log k)
+template <class T>
+void PartialSort(T* array, size_t count, size_t k)
+{
+    if (k >= count)
+    {
+        IntroSort(array, count);
+        return;
+    }
+
+    if (k == 0)
+        return;
+
+    NthElement(array, count, k - 1);
+    IntroSort(array, k - 1);
+}
+
+
+// Reverses the order of T, so a 'MaxHeap' of it has the smallest element on top.
+template <class T>
+struct ReversedOrder
+{
+    T value;
+
+    ReversedOrder() = default;
+    ReversedOrder(T value) : value(value) {}
+
+    bool operator< (const ReversedOrder<T>& other) const { return other.value < this->value; }
+    bool operator> (const ReversedOrder<T>& other) const { return this->value < other.value; }
+};
+
+// Keeps the 'k' smallest (or with LARGEST, the largest) elements of a stream in a bounded 'MaxHeap'
+// whose top is the worst element kept. Once the heap is full, that element is the threshold a new one
+// has to beat. Batches are first scanned in fixed-size chunks with a branch-free comparison against the
+// threshold, which the compiler turns into SIMD code, and chunks without any candidate are skipped.
+// Time Complexity: O(n + m log k) for m elements that beat the threshold, and O(k log k) for the result.
+// Auxiliary Space: O(k)
+constexpr size_t TOP_K_CHUNK_SIZE = 64;
+
+template <class T, bool LARGEST = false>
+class TopK
+{
+public:
+    explicit TopK(size_t k) : heap(k) {}
+
+    void Add(const T& value)
+    {
+        if (this->heap.Count() < this->heap.MaxCount())
+            this->heap.Add(value);
+        else if (this->heap.MaxCount() != 0 && IsBetter(value, this->Threshold()))
+            this->heap.ReplaceTop(value);
+    }
+
+    void Add(const T* values, size_t count)
+    {
+        size_t i = 0;
+        for (; i < count && this->heap.Count() < this->heap.MaxCount(); ++i)
+            this->heap.Add(values[i]);
+
+        if (this->heap.MaxCount() == 0)
+            return;
+
+        for (; i + TOP_K_CHUNK_SIZE <= count; i += TOP_K_CHUNK_SIZE)
+        {
+            const T threshold = this->Threshold();
+
+            unsigned candidates = 0;
+            for (size_t j = 0; j < TOP_K_CHUNK_SIZE; ++j)
+                candidates |= unsigned(IsBetter(values[i + j], threshold));
+
+            if (candidates == 0)
+                continue;
+
+            for (size_t j = 0; j < TOP_K_CHUNK_SIZE; ++j)
+                this->Add(values[i + j]);
+        }
+
+        for (; i < count; ++i)
+            this->Add(values[i]);
+    }
+
+    // Writes the kept elements, best first, to 'output' and returns how many there are.
+    size_t Result(T* output) const
+    {
+        size_t count = this->heap.Count();
+        const Entry* entries = this->heap.RawArray();
+
+        for (size_t i = 0; i < count; ++i)
+            output[i] = Unwrap(entries[i]);
+
+        IntroSort(output, count);
+        if (LARGEST)
+            Reverse(output, count);
+
+        return count;
+    }
+
+    [[nodiscard]] size_t Count() const noexcept { return this->heap.Count(); }
+
+private:
+    using Entry = std::conditional_t<LARGEST, ReversedOrder<T>, T>;
+
+    static const T& Unwrap(const T& entry)                { return entry; }
+    static const T& Unwrap(const ReversedOrder<T>& entry) { return entry.value; }
+
+    static bool IsBetter(const T& a, const T& b) { return LARGEST ? (b < a) : (a < b); }
+
+    const T& Threshold() const { return Unwrap(this->heap.Top()); }
+
+    MaxHeap<Entry> heap;
+};
+
+
+// One entry point for callers that don't want to pick an algorithm. A small, evenly spaced sample of
+// the input is inspected first:
+//  - Presortedness: how many sampled neighbours are out of order. Inputs that are (reversed) sorted
+//    or made of long runs are merged with 'NaturalMergeSort', which is O(n) on sorted input.
+//  - Duplicates and key range: integers whose sampled range is small compared to the count are
+//    checked with a full min/max scan and then counting sorted.
+//  - Key width: 32 and 64-bit integers and floats above a size threshold are radix sorted.
+//  - Size: tiny inputs are insertion sorted, and everything else goes to 'IntroSort'.
+// The sampling reads O(SORT_SAMPLE_SIZE) elements, so it's noise next to the sort itself.
+// A hint can restrict the choice, or skip the sampling when the caller already knows the input.
+enum class SortHint
+{
+    NONE,           // Sample the input and pick whatever is fastest.
+    STABLE,         // Only pick stable algorithms.
+    IN_PLACE,       // Don't allocate, i.e. only insertion sort or 'IntroSort'.
+    PARALLEL,       // Use the parallel sorts on the global thread pool for large inputs.
+    NEARLY_SORTED,  // Skip the sampling and merge the existing runs.
+};
+
+constexpr size_t SORT_SAMPLE_SIZE     = 64;
+constexpr size_t SORT_RADIX_THRESHOLD = 1 << 10;
+
+struct SortProfile
+{
+    bool   nearly_sorted;
+    size_t distinct;        // Distinct values in the sample.
+};
+
+// Looks at SORT_SAMPLE_SIZE evenly spaced pairs of neighbours. Random input has about half of them
+// descending, while sorted, reversed or run-structured input has almost none (or almost all).
+template <class T>
+SortProfile SampleInput(const T* array, size_t count)
+{
+    T sample[SORT_SAMPLE_SIZE];
+    size_t descents = 0;
+
+    for (size_t i = 0; i < SORT_SAMPLE_SIZE; ++i)
+    {
+        size_t index = i * (count - 1) / SORT_SAMPLE_SIZE;
+        descents += size_t(array[index + 1] < array[index]);
+        sample[i] = array[index];
+    }
+
+    InsertionSort(sample, SORT_SAMPLE_SIZE);
+
+    size_t distinct = 1;
+    for (size_t i = 1; i < SORT_SAMPLE_SIZE; ++i)
+        distinct += size_t(sample[i - 1] < sample[i]);
+
+    SortProfile profile;
+    profile.nearly_sorted = descents <= SORT_SAMPLE_SIZE / 16 || descents >= SORT_SAMPLE_SIZE - SORT_SAMPLE_SIZE / 16;
+    profile.distinct      = distinct;
+    return profile;
+}
+
+// Whether every value is within a range of at most 'count', which makes counting sort O(n) with O(n)
+// memory. The sample only decides if the full scan is worth it.
+template <class T>
+bool HasNarrowRange(const T* array, size_t count, const SortProfile& profile)
+{
+    if (profile.distinct > SORT_SAMPLE_SIZE / 2)
+        return false;
+
+    const auto& [minimum, maximum] = MinMax(array, count);
+    return size_t(maximum) - size_t(minimum) < count;
+}
+
+template <class T>
+void Sort(T* array, size_t count, SortHint hint = SortHint::NONE)
+{
+    constexpr bool RADIX_KEY    = std::is_arithmetic_v<T> && (sizeof(T) == 4 || sizeof(T) == 8);
+    constexpr bool COUNTING_KEY = std::is_integral_v<T> && !std::is_same_v<T, bool>;
+
+    if (count < INTRO_SORT_INSERTION_THRESHOLD)
+    {
+        InsertionSort(array, count);
+        return;
+    }
+
+    if (hint == SortHint::NEARLY_SORTED)
+    {
+        NaturalMergeSort(array, count);
+        return;
+    }
+
+    if (hint == SortHint::PARALLEL && count >= 2 * PARALLEL_SORT_GRAIN_SIZE && ThreadPool::Global().ThreadCount() > 1)
+    {
+        ParallelQuickSort(array, count);
+        return;
+    }
+
+    if (hint == SortHint::IN_PLACE)
+    {
+        IntroSort(array, count);
+        return;
+    }
+
+    SortProfile profile = SampleInput(array, count);
+
+    if (profile.nearly_sorted)
+    {
+        NaturalMergeSort(array, count);
+        return;
+    }
+
+    if constexpr (COUNTING_KEY)
+    {
+        if (HasNarrowRange(array, count, profile))
+        {
+            CountingSort(array, count);
+            return;
+        }
+    }
+
+    if constexpr (RADIX_KEY)
+    {
+        if (count >= SORT_RADIX_THRESHOLD)
+        {
+            RadixSort(array, count);
+            return;
+        }
+    }
+
+    if (hint == SortHint::STABLE)
+        NaturalMergeSort(array, count);
+    else
+        IntroSort(array, count);
+}
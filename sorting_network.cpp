@@ -0,0 +1,257 @@
+#include "sorting_network.h"
+
+#include <cstring>
+#include <limits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SORTING_NETWORK_X86 1
+#include <immintrin.h>
+#else
+#define SORTING_NETWORK_X86 0
+#endif
+
+
+#if SORTING_NETWORK_X86
+
+#define TARGET_AVX2  __attribute__((target("avx2")))
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+
+// Every step of the network compares each lane with the lane at 'lane ^ partner_xor' and keeps the
+// maximum in the lanes that have 'max_bit' set. With partner_xor = group - 1 and max_bit = group / 2,
+// that compares the mirrored lanes of each group, which merges two sorted halves into a bitonic
+// sequence. With partner_xor = max_bit = stride, it's the half-cleaner that sorts a bitonic sequence.
+
+
+// ---- AVX2, 8 lanes per register ----
+TARGET_AVX2 static inline __m256i CompareExchangeAvx2(__m256i v, int partner_xor, int max_bit)
+{
+    const __m256i lanes    = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i partner  = _mm256_xor_si256(lanes, _mm256_set1_epi32(partner_xor));
+    const __m256i bit      = _mm256_set1_epi32(max_bit);
+    const __m256i take_max = _mm256_cmpeq_epi32(_mm256_and_si256(lanes, bit), bit);
+
+    __m256i other = _mm256_permutevar8x32_epi32(v, partner);
+    return _mm256_blendv_epi8(_mm256_min_epi32(v, other), _mm256_max_epi32(v, other), take_max);
+}
+
+TARGET_AVX2 static inline __m256i ReverseAvx2(__m256i v)
+{
+    return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+TARGET_AVX2 static inline __m256i SortRegisterAvx2(__m256i v)
+{
+    for (int group = 2; group <= 8; group *= 2)
+    {
+        v = CompareExchangeAvx2(v, group - 1, group / 2);
+        for (int stride = group / 4; stride >= 1; stride /= 2)
+            v = CompareExchangeAvx2(v, stride, stride);
+    }
+    return v;
+}
+
+// Merges the sorted halves regs[0, count/2) and regs[count/2, count).
+TARGET_AVX2 static inline void MergeRegistersAvx2(__m256i* regs, size_t count)
+{
+    for (size_t i = 0; i < count / 2; ++i)
+    {
+        __m256i a = regs[i];
+        __m256i b = ReverseAvx2(regs[count - 1 - i]);
+
+        regs[i]             = _mm256_min_epi32(a, b);
+        regs[count - 1 - i] = ReverseAvx2(_mm256_max_epi32(a, b));
+    }
+
+    for (size_t stride = count / 4; stride >= 1; stride /= 2)
+        for (size_t i = 0; i < count; ++i)
+            if ((i & stride) == 0)
+            {
+                __m256i a = regs[i];
+                __m256i b = regs[i + stride];
+
+                regs[i]          = _mm256_min_epi32(a, b);
+                regs[i + stride] = _mm256_max_epi32(a, b);
+            }
+
+    for (size_t i = 0; i < count; ++i)
+        for (int stride = 4; stride >= 1; stride /= 2)
+            regs[i] = CompareExchangeAvx2(regs[i], stride, stride);
+}
+
+TARGET_AVX2 static void SortingNetworkAvx2(int32_t* data, size_t register_count)
+{
+    __m256i regs[SORTING_NETWORK_MAX_COUNT / 8];
+
+    for (size_t i = 0; i < register_count; ++i)
+        regs[i] = SortRegisterAvx2(_mm256_loadu_si256((const __m256i*) (data + 8 * i)));
+
+    for (size_t width = 2; width <= register_count; width *= 2)
+        for (size_t i = 0; i < register_count; i += width)
+            MergeRegistersAvx2(regs + i, width);
+
+    for (size_t i = 0; i < register_count; ++i)
+        _mm256_storeu_si256((__m256i*) (data + 8 * i), regs[i]);
+}
+
+
+// ---- SSE4.1, 4 lanes per register ----
+TARGET_SSE41 static inline __m128i CompareExchangeSse41(__m128i v, int partner_xor, int max_bit)
+{
+    __m128i other;
+    switch (partner_xor)
+    {
+        case 1:  other = _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)); break;
+        case 2:  other = _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)); break;
+        default: other = _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3)); break;
+    }
+
+    const __m128i lanes    = _mm_setr_epi32(0, 1, 2, 3);
+    const __m128i bit      = _mm_set1_epi32(max_bit);
+    const __m128i take_max = _mm_cmpeq_epi32(_mm_and_si128(lanes, bit), bit);
+
+    return _mm_blendv_epi8(_mm_min_epi32(v, other), _mm_max_epi32(v, other), take_max);
+}
+
+TARGET_SSE41 static inline __m128i ReverseSse41(__m128i v)
+{
+    return _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+}
+
+TARGET_SSE41 static inline __m128i SortRegisterSse41(__m128i v)
+{
+    v = CompareExchangeSse41(v, 1, 1);
+    v = CompareExchangeSse41(v, 3, 2);
+    v = CompareExchangeSse41(v, 1, 1);
+    return v;
+}
+
+// Merges the sorted halves regs[0, count/2) and regs[count/2, count).
+TARGET_SSE41 static inline void MergeRegistersSse41(__m128i* regs, size_t count)
+{
+    for (size_t i = 0; i < count / 2; ++i)
+    {
+        __m128i a = regs[i];
+        __m128i b = ReverseSse41(regs[count - 1 - i]);
+
+        regs[i]             = _mm_min_epi32(a, b);
+        regs[count - 1 - i] = ReverseSse41(_mm_max_epi32(a, b));
+    }
+
+    for (size_t stride = count / 4; stride >= 1; stride /= 2)
+        for (size_t i = 0; i < count; ++i)
+            if ((i & stride) == 0)
+            {
+                __m128i a = regs[i];
+                __m128i b = regs[i + stride];
+
+                regs[i]          = _mm_min_epi32(a, b);
+                regs[i + stride] = _mm_max_epi32(a, b);
+            }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        regs[i] = CompareExchangeSse41(regs[i], 2, 2);
+        regs[i] = CompareExchangeSse41(regs[i], 1, 1);
+    }
+}
+
+TARGET_SSE41 static void SortingNetworkSse41(int32_t* data, size_t register_count)
+{
+    __m128i regs[SORTING_NETWORK_MAX_COUNT / 4];
+
+    for (size_t i = 0; i < register_count; ++i)
+        regs[i] = SortRegisterSse41(_mm_loadu_si128((const __m128i*) (data + 4 * i)));
+
+    for (size_t width = 2; width <= register_count; width *= 2)
+        for (size_t i = 0; i < register_count; i += width)
+            MergeRegistersSse41(regs + i, width);
+
+    for (size_t i = 0; i < register_count; ++i)
+        _mm_storeu_si128((__m128i*) (data + 4 * i), regs[i]);
+}
+
+
+enum class SortingNetworkIsa { NONE, SSE41, AVX2 };
+
+static SortingNetworkIsa DetectIsa()
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return SortingNetworkIsa::AVX2;
+    if (__builtin_cpu_supports("sse4.1"))
+        return SortingNetworkIsa::SSE41;
+    return SortingNetworkIsa::NONE;
+}
+
+// Sorts 'count' values in a padded copy, so the network always sees a power of two of full registers.
+static bool SortPadded(int32_t* array, size_t count)
+{
+    static const SortingNetworkIsa isa = DetectIsa();
+
+    if (isa == SortingNetworkIsa::NONE || count > SORTING_NETWORK_MAX_COUNT)
+        return false;
+
+    if (count <= 1)
+        return true;
+
+    const size_t lanes = (isa == SortingNetworkIsa::AVX2) ? 8 : 4;
+
+    size_t register_count = 1;
+    while (register_count * lanes < count)
+        register_count *= 2;
+
+    int32_t padded[SORTING_NETWORK_MAX_COUNT];
+    memcpy(padded, array, count * sizeof(int32_t));
+    for (size_t i = count; i < register_count * lanes; ++i)
+        padded[i] = std::numeric_limits<int32_t>::max();
+
+    if (isa == SortingNetworkIsa::AVX2)
+        SortingNetworkAvx2(padded, register_count);
+    else
+        SortingNetworkSse41(padded, register_count);
+
+    memcpy(array, padded, count * sizeof(int32_t));
+    return true;
+}
+
+#else
+
+static bool SortPadded(int32_t*, size_t)
+{
+    return false;
+}
+
+#endif
+
+
+bool SortingNetworkSort(int32_t* array, size_t count)
+{
+    return SortPadded(array, count);
+}
+
+bool SortingNetworkSort(float* array, size_t count)
+{
+    static_assert(sizeof(float) == sizeof(int32_t), "Floats are sorted as 32-bit integers.");
+
+    if (count > SORTING_NETWORK_MAX_COUNT)
+        return false;
+
+    if (count <= 1)
+        return SortPadded(nullptr, 0);
+
+    // Flipping the magnitude bits of negative floats gives signed integers with the same order as the
+    // floats. The mapping is its own inverse.
+    int32_t keys[SORTING_NETWORK_MAX_COUNT];
+    memcpy(keys, array, count * sizeof(float));
+    for (size_t i = 0; i < count; ++i)
+        keys[i] ^= (keys[i] >> 31) & 0x7FFFFFFF;
+
+    if (!SortPadded(keys, count))
+        return false;
+
+    for (size_t i = 0; i < count; ++i)
+        keys[i] ^= (keys[i] >> 31) & 0x7FFFFFFF;
+    memcpy(array, keys, count * sizeof(float));
+
+    return true;
+}
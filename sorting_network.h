@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+// Bitonic sorting networks on SIMD registers, used as the base case of the sorts in sorting.cpp.
+// https://en.wikipedia.org/wiki/Bitonic_sorter
+//
+// The array is padded to a power of two with the largest value and loaded into 8-lane (AVX2) or
+// 4-lane (SSE4.1) registers. Every register is sorted in place, then the registers are merged in
+// pairs, fours and eights, so there are no data dependent branches at all. The instruction set is
+// picked at runtime from what the CPU supports. Floats are sorted as integers with the same order,
+// so -0.0 < 0.0 and NaNs end up at the ends instead of poisoning the min/max instructions.
+constexpr size_t SORTING_NETWORK_MIN_COUNT = 8;
+constexpr size_t SORTING_NETWORK_MAX_COUNT = 64;
+
+// Returns false, and leaves the array untouched, if 'count' is larger than SORTING_NETWORK_MAX_COUNT
+// or the CPU supports neither AVX2 nor SSE4.1.
+bool SortingNetworkSort(int32_t* array, size_t count);
+bool SortingNetworkSort(float*   array, size_t count);
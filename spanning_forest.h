@@ -0,0 +1,207 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+#include "graphs.h"
+#include "sorting.h"
+#include "thread_pool.h"
+#include "data_structures/union_find.h"
+
+
+// Minimum spanning forests, i.e. a minimum spanning tree of every connected component.
+// https://en.wikipedia.org/wiki/Minimum_spanning_tree
+// The graph must be undirected: every edge is listed in both directions with the same weight. The
+// forest is returned as one edge per tree edge, with source < target. Self-loops are ignored.
+constexpr size_t SPANNING_FOREST_GRAIN_SIZE = 1 << 12;   // Vertices per task.
+
+template <class W>
+struct SpanningForestEdge
+{
+    W        weight;
+    uint32_t source;
+    uint32_t target;
+
+    bool operator< (const SpanningForestEdge<W>& other) const { return this->weight < other.weight; }
+    bool operator> (const SpanningForestEdge<W>& other) const { return other < *this; }
+};
+
+// Radix sorted whenever the weights are 32 or 64-bit numbers, like 'Sort' does, since it has no
+// bad inputs; other weights are sorted in parallel when the pool has the threads for it.
+template <class W>
+void SortByWeight(SpanningForestEdge<W>* edges, size_t count, ThreadPool& pool)
+{
+    if constexpr (std::is_arithmetic_v<W> && (sizeof(W) == 4 || sizeof(W) == 8))
+        RadixSortBy(edges, count, [](const SpanningForestEdge<W>& edge) { return ToRadixKey(edge.weight); });
+    else if (pool.ThreadCount() > 1 && count >= 2 * PARALLEL_SORT_GRAIN_SIZE)
+        ParallelQuickSort(edges, count, PARALLEL_SORT_GRAIN_SIZE, pool);
+    else
+        IntroSort(edges, count);
+}
+
+
+// https://en.wikipedia.org/wiki/Kruskal%27s_algorithm
+// Sorts the edges by weight, by radix or in parallel, and adds them lightest first unless 'WQUPC'
+// says both ends are already in the same tree. Stops as soon as the forest has V - 1 edges.
+// Time Complexity: O(E log E) with a comparison sort, O(E α(V)) with a radix sort.
+// Auxiliary Space: O(V + E)
+template <class W>
+DynamicArray<WeightedCsrEdge<W>> Kruskal(const WeightedCsrGraph<W>& graph, ThreadPool& pool = ThreadPool::Global())
+{
+    const size_t vertex_count = graph.VertexCount();
+
+    // Every edge once, from its lower end.
+    std::vector<SpanningForestEdge<W>> edges;
+    edges.reserve(graph.EdgeCount() / 2);
+    for (uint32_t source = 0; source < vertex_count; ++source)
+    {
+        const auto& neighbours = graph.Edge(source);
+        const W*    weights    = graph.Weights(source);
+
+        for (size_t i = 0; i < neighbours.Count(); ++i)
+            if (source < neighbours[i])
+                edges.push_back({ weights[i], source, neighbours[i] });
+    }
+
+    SortByWeight(edges.data(), edges.size(), pool);
+
+    WQUPC trees(vertex_count);
+    DynamicArray<WeightedCsrEdge<W>> forest(vertex_count);
+
+    for (const SpanningForestEdge<W>& edge : edges)
+    {
+        if (forest.Count() + 1 >= vertex_count)
+            break;
+
+        if (trees.Union(edge.source, edge.target))
+        {
+            WeightedCsrEdge<W> tree_edge = { edge.source, edge.target, edge.weight };
+            forest.Add(&tree_edge, 1);
+        }
+    }
+
+    return forest;
+}
+
+
+// https://en.wikipedia.org/wiki/Bor%C5%AFvka%27s_algorithm
+// Every round, each component picks the lightest edge leaving it and all of them are added at once,
+// which at least halves the number of components. The search for the lightest edges, which reads
+// every remaining edge, runs in parallel: each vertex finds its own lightest edge out of the component
+// and then offers it to its component with a compare-and-swap. Ties are broken by the ends of the
+// edges, so the picked edges can't form a cycle; only the two directions of parallel edges can pick
+// the same pair of components twice, which 'WQUPC' filters out. Vertices that have no edges out of
+// their component are dropped for good, since components only grow.
+// Time Complexity: O(E log V), or O(E log V / P) with P threads.
+// Auxiliary Space: O(V)
+template <class W>
+DynamicArray<WeightedCsrEdge<W>> Boruvka(const WeightedCsrGraph<W>& graph, ThreadPool& pool = ThreadPool::Global())
+{
+    constexpr size_t NO_EDGE = SIZE_MAX;
+
+    const size_t    vertex_count = graph.VertexCount();
+    const size_t*   offsets      = graph.Offsets();
+    const uint32_t* neighbours   = graph.Neighbours();
+    const W*        weights      = graph.Weights();
+
+    auto components = make_unique<uint32_t[]>(vertex_count);   // The representative of each vertex' component.
+    auto renamed    = make_unique<uint32_t[]>(vertex_count);   // The new representative of each merged one.
+    auto best_edges = make_unique<size_t[]>(vertex_count);     // The lightest edge out of each vertex' component.
+    auto cheapest   = make_unique<std::atomic<uint32_t>[]>(vertex_count);   // The vertex with the lightest edge per component.
+
+    std::iota(components.get(), components.get() + vertex_count, uint32_t(0));
+    std::iota(renamed.get(),    renamed.get()    + vertex_count, uint32_t(0));
+
+    std::vector<uint32_t> active(vertex_count);
+    std::vector<uint32_t> representatives(vertex_count);
+    std::iota(active.begin(), active.end(), uint32_t(0));
+    std::iota(representatives.begin(), representatives.end(), uint32_t(0));
+
+    // Orders the edges by weight, then by their lower and higher ends.
+    auto lighter = [&](size_t a, uint32_t a_source, size_t b, uint32_t b_source)
+    {
+        if (weights[a] < weights[b]) return true;
+        if (weights[b] < weights[a]) return false;
+
+        uint32_t a_target = neighbours[a];
+        uint32_t b_target = neighbours[b];
+        auto a_ends = std::make_pair(std::min(a_source, a_target), std::max(a_source, a_target));
+        auto b_ends = std::make_pair(std::min(b_source, b_target), std::max(b_source, b_target));
+        return a_ends < b_ends;
+    };
+
+    WQUPC trees(vertex_count);
+    DynamicArray<WeightedCsrEdge<W>> forest(vertex_count);
+
+    while (!representatives.empty())
+    {
+        for (uint32_t representative : representatives)
+            cheapest[representative].store(NO_VERTEX, std::memory_order_relaxed);
+
+        ParallelFor(pool, 0, active.size(), SPANNING_FOREST_GRAIN_SIZE, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                const uint32_t vertex    = active[i];
+                const uint32_t component = components[vertex];
+
+                size_t best = NO_EDGE;
+                for (size_t j = offsets[vertex]; j < offsets[vertex + 1]; ++j)
+                    if (components[neighbours[j]] != component && (best == NO_EDGE || lighter(j, vertex, best, vertex)))
+                        best = j;
+
+                best_edges[vertex] = best;
+                if (best == NO_EDGE)
+                    continue;
+
+                // The release publishes 'best_edges[vertex]' to the threads that compare against it.
+                uint32_t current = cheapest[component].load(std::memory_order_acquire);
+                while ((current == NO_VERTEX || lighter(best, vertex, best_edges[current], current)) &&
+                       !cheapest[component].compare_exchange_weak(current, vertex, std::memory_order_acq_rel, std::memory_order_acquire))
+                    ;
+            }
+        });
+
+        active.erase(std::remove_if(active.begin(), active.end(), [&](uint32_t vertex) { return best_edges[vertex] == NO_EDGE; }), active.end());
+
+        // Components without an edge out of them are done.
+        representatives.erase(std::remove_if(representatives.begin(), representatives.end(), [&](uint32_t representative)
+        {
+            return cheapest[representative].load(std::memory_order_relaxed) == NO_VERTEX;
+        }), representatives.end());
+
+        for (uint32_t representative : representatives)
+        {
+            const uint32_t source = cheapest[representative].load(std::memory_order_relaxed);
+            const size_t   edge   = best_edges[source];
+            const uint32_t target = neighbours[edge];
+
+            if (trees.Union(representative, components[target]))
+            {
+                WeightedCsrEdge<W> tree_edge = { std::min(source, target), std::max(source, target), weights[edge] };
+                forest.Add(&tree_edge, 1);
+            }
+        }
+
+        for (uint32_t representative : representatives)
+            renamed[representative] = uint32_t(trees.FindRoot(representative));
+
+        representatives.erase(std::remove_if(representatives.begin(), representatives.end(), [&](uint32_t representative)
+        {
+            return renamed[representative] != representative;
+        }), representatives.end());
+
+        ParallelFor(pool, 0, vertex_count, SPANNING_FOREST_GRAIN_SIZE, [&](size_t begin, size_t end)
+        {
+            for (size_t vertex = begin; vertex < end; ++vertex)
+                components[vertex] = renamed[components[vertex]];
+        });
+    }
+
+    return forest;
+}
@@ -0,0 +1,114 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+
+static thread_local ThreadPool* current_pool  = nullptr;
+static thread_local size_t      current_index = 0;
+
+
+ThreadPool::ThreadPool(size_t worker_count) :
+    worker_count(worker_count), queues(make_unique<WorkQueue[]>(worker_count + 1)), queued(0), stopping(false)
+{
+    this->workers.reserve(worker_count);
+    for (size_t i = 0; i < worker_count; ++i)
+        this->workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->sleep_mutex);
+        this->stopping = true;
+    }
+    this->wake.notify_all();
+
+    for (auto& worker : this->workers)
+        worker.join();
+}
+
+ThreadPool& ThreadPool::Global()
+{
+    static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+    return pool;
+}
+
+size_t ThreadPool::CurrentQueue() const noexcept
+{
+    return (current_pool == this) ? current_index : this->worker_count;
+}
+
+void ThreadPool::Submit(Task task)
+{
+    WorkQueue& queue = this->queues[this->CurrentQueue()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    this->queued.fetch_add(1, std::memory_order_release);
+
+    // Taking the lock makes sure a worker can't check 'queued' and then miss the notification.
+    { std::lock_guard<std::mutex> lock(this->sleep_mutex); }
+    this->wake.notify_one();
+}
+
+bool ThreadPool::RunPendingTask()
+{
+    size_t index = this->CurrentQueue();
+
+    Task task;
+    if (!this->PopTask(index, task) && !this->StealTask(index, task))
+        return false;
+
+    this->queued.fetch_sub(1, std::memory_order_relaxed);
+    task();
+    return true;
+}
+
+bool ThreadPool::PopTask(size_t queue_index, Task& task)
+{
+    WorkQueue& queue = this->queues[queue_index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+
+    if (queue.tasks.empty())
+        return false;
+
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::StealTask(size_t thief_index, Task& task)
+{
+    size_t queue_count = this->worker_count + 1;
+
+    for (size_t i = 1; i < queue_count; ++i)
+    {
+        WorkQueue& queue = this->queues[(thief_index + i) % queue_count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (queue.tasks.empty())
+            continue;
+
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        return true;
+    }
+
+    return false;
+}
+
+void ThreadPool::WorkerLoop(size_t index)
+{
+    current_pool  = this;
+    current_index = index;
+
+    while (!this->stopping.load(std::memory_order_relaxed))
+    {
+        if (this->RunPendingTask())
+            continue;
+
+        std::unique_lock<std::mutex> lock(this->sleep_mutex);
+        this->wake.wait(lock, [this] { return this->stopping || this->queued.load(std::memory_order_acquire) > 0; });
+    }
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using std::unique_ptr;
+using std::make_unique;
+
+
+// Work-stealing pool for fork-join parallelism. Every worker owns a deque of tasks: it pushes
+// and pops at the back of its own deque (LIFO, so the data is still in cache) and steals from
+// the front of the others (FIFO, which are the largest pieces of work) when it runs dry.
+// Threads outside the pool share one extra deque.
+class ThreadPool
+{
+public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(size_t worker_count);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator= (const ThreadPool&) = delete;
+
+    void Submit(Task task);
+
+    // Runs one queued task on the calling thread, if there is any. Used by threads that wait
+    // on other tasks, so they help out instead of blocking.
+    bool RunPendingTask();
+
+    // The workers plus the thread that waits on the work.
+    [[nodiscard]] size_t ThreadCount() const noexcept { return this->worker_count + 1; }
+
+    // Shared pool with one worker less than there are hardware threads.
+    static ThreadPool& Global();
+
+private:
+    struct WorkQueue
+    {
+        std::mutex       mutex;
+        std::deque<Task> tasks;
+    };
+
+    size_t CurrentQueue() const noexcept;
+    bool PopTask(size_t queue_index, Task& task);
+    bool StealTask(size_t thief_index, Task& task);
+    void WorkerLoop(size_t index);
+
+    size_t worker_count;
+    unique_ptr<WorkQueue[]>  queues;   // One per worker, and the shared one at [worker_count].
+    std::vector<std::thread> workers;
+
+    std::atomic<size_t> queued;
+    std::atomic<bool>   stopping;
+
+    std::mutex              sleep_mutex;
+    std::condition_variable wake;
+};
+
+
+// Tracks a set of forked tasks. 'Wait' runs other pending tasks until all of them are done,
+// so nested groups never deadlock, even on a pool without workers.
+class TaskGroup
+{
+public:
+    explicit TaskGroup(ThreadPool& pool) : pool(pool), pending(0) {}
+    ~TaskGroup() { this->Wait(); }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator= (const TaskGroup&) = delete;
+
+    template <class F>
+    void Run(F&& function)
+    {
+        this->pending.fetch_add(1, std::memory_order_relaxed);
+        this->pool.Submit([this, function = std::forward<F>(function)]() mutable
+        {
+            function();
+            this->pending.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    void Wait()
+    {
+        while (this->pending.load(std::memory_order_acquire) != 0)
+            if (!this->pool.RunPendingTask())
+                std::this_thread::yield();
+    }
+
+private:
+    ThreadPool& pool;
+    std::atomic<size_t> pending;
+};
+
+
+// Calls 'function(begin, end)' on disjoint sub-ranges of at most 'grain_size' elements.
+template <class F>
+void ParallelFor(ThreadPool& pool, size_t begin, size_t end, size_t grain_size, F&& function)
+{
+    if (end - begin <= grain_size || end - begin < 2)
+    {
+        function(begin, end);
+        return;
+    }
+
+    size_t middle = begin + (end - begin) / 2;
+
+    TaskGroup group(pool);
+    group.Run([&] { ParallelFor(pool, begin, middle, grain_size, function); });
+    ParallelFor(pool, middle, end, grain_size, function);
+    group.Wait();
+}
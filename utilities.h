@@ -15,7 +15,7 @@ inline void Swap(T* a, T* b)
 }
 
 template <class T>
-inline void Copy(T* array_a, size_t count_a, T* array_b, size_t count_b)
+inline void Copy(T* array_a, size_t count_a, const T* array_b, size_t count_b)
 {
     if (count_a > count_b)
         throw std::runtime_error("Destination array is smaller than source.");
@@ -65,6 +65,31 @@ inline T Max(const T* array, size_t count)
             maximum = array[i];
     return maximum;
 }
+
+// Floor of the base 2 logarithm, and 0 for 0.
+inline size_t Log2(size_t value)
+{
+    size_t result = 0;
+    while (value > 1)
+    {
+        value /= 2;
+        ++result;
+    }
+    return result;
+}
+
+// Replaces every count with the sum of the counts before it, turning counts into start offsets.
+inline void ExclusivePrefixSum(size_t* counts, size_t count)
+{
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t temp = counts[i];
+        counts[i] = total;
+        total += temp;
+    }
+}
+
 template <class T>
 inline bool InRange(T value, T minimum, T maximum)
 {